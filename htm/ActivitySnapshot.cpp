@@ -0,0 +1,130 @@
+#include "ActivitySnapshot.h"
+#include "Region.h"
+#include "Column.h"
+#include "Cell.h"
+
+// DataSpaceSnapshot
+
+DataSpaceSnapshot::DataSpaceSnapshot(DataSpace *_dataSpace)
+{
+	dataSpace = _dataSpace;
+	region = (dataSpace->GetDataSpaceType() == DATASPACE_TYPE_REGION) ? (Region*)dataSpace : NULL;
+	sizeX = dataSpace->GetSizeX();
+	sizeY = dataSpace->GetSizeY();
+	numItems = (region != NULL) ? region->GetCellsPerCol() : dataSpace->GetNumValues();
+
+	cellFlags = new unsigned char[sizeX * sizeY * numItems];
+	numPredictionSteps = new unsigned char[sizeX * sizeY * numItems];
+	boosts = new float[sizeX * sizeY];
+
+	for (int i = 0; i < sizeX * sizeY * numItems; i++) 
+	{
+		cellFlags[i] = 0;
+		numPredictionSteps[i] = 0;
+	}
+
+	for (int i = 0; i < sizeX * sizeY; i++) {
+		boosts[i] = 1.0f;
+	}
+}
+
+DataSpaceSnapshot::~DataSpaceSnapshot()
+{
+	delete [] cellFlags;
+	delete [] numPredictionSteps;
+	delete [] boosts;
+}
+
+/// Copy the current state of the DataSpace into this snapshot.
+void DataSpaceSnapshot::Capture()
+{
+	int i, itemIndex = 0;
+	unsigned char flags;
+
+	if (region == NULL)
+	{
+		// Items are in the same order as the DataSpace's value indices.
+		const BitArray &activeBits = dataSpace->DetermineActiveBits();
+		for (itemIndex = 0; itemIndex < sizeX * sizeY * numItems; itemIndex++) {
+			cellFlags[itemIndex] = activeBits.Get(itemIndex) ? SNAPSHOT_ACTIVE : 0;
+		}
+
+		return;
+	}
+
+	Column *col;
+	Cell *cell;
+
+	for (int colIndex = 0; colIndex < sizeX * sizeY; colIndex++)
+	{
+		col = region->Columns[colIndex];
+		boosts[colIndex] = col->GetBoost();
+
+		for (i = 0; i < numItems; i++, itemIndex++)
+		{
+			cell = col->Cells[i];
+
+			flags = 0;
+			if (cell->GetIsActive()) flags |= SNAPSHOT_ACTIVE;
+			if (cell->GetIsPredicting()) flags |= SNAPSHOT_PREDICTED;
+			if (cell->GetIsLearning()) flags |= SNAPSHOT_LEARNING;
+
+			cellFlags[itemIndex] = flags;
+			numPredictionSteps[itemIndex] = (unsigned char)Min(cell->GetNumPredictionSteps(), 255);
+		}
+	}
+
+	profiler = region->GetProfiler();
+}
+
+// NetworkSnapshot
+
+NetworkSnapshot::NetworkSnapshot()
+{
+	time = 0;
+}
+
+NetworkSnapshot::~NetworkSnapshot()
+{
+	Clear();
+}
+
+/// Remove all DataSpaces from this snapshot.
+void NetworkSnapshot::Clear()
+{
+	for (std::vector<DataSpaceSnapshot*>::const_iterator snapshot_iter = dataSpaceSnapshots.begin(), end = dataSpaceSnapshots.end(); snapshot_iter != end; ++snapshot_iter) {
+		delete (*snapshot_iter);
+	}
+
+	dataSpaceSnapshots.clear();
+	time = 0;
+}
+
+/// Add a DataSpace to those captured by this snapshot.
+void NetworkSnapshot::AddDataSpace(DataSpace *_dataSpace)
+{
+	dataSpaceSnapshots.push_back(new DataSpaceSnapshot(_dataSpace));
+}
+
+/// Copy the current state of every DataSpace into this snapshot, recording the given time.
+void NetworkSnapshot::Capture(int _time)
+{
+	time = _time;
+
+	for (std::vector<DataSpaceSnapshot*>::const_iterator snapshot_iter = dataSpaceSnapshots.begin(), end = dataSpaceSnapshots.end(); snapshot_iter != end; ++snapshot_iter) {
+		(*snapshot_iter)->Capture();
+	}
+}
+
+/// Returns the snapshot of the given DataSpace, or NULL if it is not part of this snapshot.
+DataSpaceSnapshot *NetworkSnapshot::GetDataSpaceSnapshot(DataSpace *_dataSpace)
+{
+	for (std::vector<DataSpaceSnapshot*>::const_iterator snapshot_iter = dataSpaceSnapshots.begin(), end = dataSpaceSnapshots.end(); snapshot_iter != end; ++snapshot_iter) 
+	{
+		if ((*snapshot_iter)->GetDataSpace() == _dataSpace) {
+			return (*snapshot_iter);
+		}
+	}
+
+	return NULL;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+#include "DataSpace.h"
+#include "StepProfiler.h"
+
+class Region;
+
+// Flags recorded for each cell (or input value) in a DataSpaceSnapshot.
+const unsigned char SNAPSHOT_ACTIVE    = 1;
+const unsigned char SNAPSHOT_PREDICTED = 2;
+const unsigned char SNAPSHOT_LEARNING  = 4;
+
+/// A copy of the state of one InputSpace or Region that is needed to display it: the activity,
+/// prediction and learning state of each cell, and the boost of each column.
+///
+/// A snapshot is captured between time steps, after which it does not change, so it can be read
+/// by the UI while the network continues to run.
+class DataSpaceSnapshot
+{
+public:
+	DataSpaceSnapshot(DataSpace *_dataSpace);
+	~DataSpaceSnapshot();
+
+	/// Copy the current state of the DataSpace into this snapshot.
+	void Capture();
+
+	DataSpace *GetDataSpace() {return dataSpace;}
+
+	int GetSizeX() {return sizeX;}
+	int GetSizeY() {return sizeY;}
+	int GetNumItems() {return numItems;}
+
+	bool GetIsActive(int _x, int _y, int _index) {return (cellFlags[GetItemIndex(_x, _y, _index)] & SNAPSHOT_ACTIVE) != 0;}
+	bool GetIsPredicted(int _x, int _y, int _index) {return (cellFlags[GetItemIndex(_x, _y, _index)] & SNAPSHOT_PREDICTED) != 0;}
+	bool GetIsLearning(int _x, int _y, int _index) {return (cellFlags[GetItemIndex(_x, _y, _index)] & SNAPSHOT_LEARNING) != 0;}
+	int GetNumPredictionSteps(int _x, int _y, int _index) {return numPredictionSteps[GetItemIndex(_x, _y, _index)];}
+
+	// Returns the Boost of the column at the given position. Always 1 for an InputSpace.
+	float GetBoost(int _x, int _y) {return boosts[_x + (_y * sizeX)];}
+
+	// Returns a copy of the Region's StepProfiler. Empty for an InputSpace.
+	StepProfiler &GetProfiler() {return profiler;}
+
+private:
+
+	int GetItemIndex(int _x, int _y, int _index) {return (((_y * sizeX) + _x) * numItems) + _index;}
+
+	DataSpace *dataSpace;
+	Region *region;
+	int sizeX, sizeY, numItems;
+	unsigned char *cellFlags, *numPredictionSteps;
+	float *boosts;
+	StepProfiler profiler;
+};
+
+/// A snapshot of every InputSpace and Region in a network, taken at the end of one time step.
+class NetworkSnapshot
+{
+public:
+	NetworkSnapshot();
+	~NetworkSnapshot();
+
+	/// Remove all DataSpaces from this snapshot.
+	void Clear();
+
+	/// Add a DataSpace to those captured by this snapshot.
+	void AddDataSpace(DataSpace *_dataSpace);
+
+	/// Copy the current state of every DataSpace into this snapshot, recording the given time.
+	void Capture(int _time);
+
+	int GetTime() {return time;}
+
+	/// Returns the snapshot of the given DataSpace, or NULL if it is not part of this snapshot.
+	DataSpaceSnapshot *GetDataSpaceSnapshot(DataSpace *_dataSpace);
+
+private:
+	std::vector<DataSpaceSnapshot*> dataSpaceSnapshots;
+	int time;
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+#include <string.h>
+#include <stdint.h>
+#include <crtdbg.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+typedef uint64_t BitWord;
+const int BITS_PER_WORD = 64;
+
+/// Returns the index of the lowest set bit of the given word, which must not be 0.
+inline int LowestSetBit(BitWord _word)
+{
+	_ASSERT(_word != 0);
+
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, _word);
+	return (int)index;
+#elif defined(_MSC_VER)
+	// _BitScanForward64() is only available on x64, so scan each 32 bit half of the word.
+	unsigned long index;
+	if (_BitScanForward(&index, (unsigned long)_word)) {
+		return (int)index;
+	}
+	_BitScanForward(&index, (unsigned long)(_word >> 32));
+	return (int)index + 32;
+#else
+	return __builtin_ctzll(_word);
+#endif
+}
+
+/// A fixed size array of bits, packed into 64 bit words. Bits past the end of the array, in the last
+/// word, are always 0, so whole words may be scanned without masking.
+class BitArray
+{
+public:
+	BitArray() : numBits(0) {}
+
+	/// Set the number of bits in the array, clearing all of them.
+	void Resize(int _numBits)
+	{
+		numBits = _numBits;
+		words.assign((_numBits + BITS_PER_WORD - 1) / BITS_PER_WORD, 0);
+	}
+
+	void ClearAll()
+	{
+		if (words.size() > 0) {
+			memset(&words[0], 0, words.size() * sizeof(BitWord));
+		}
+	}
+
+	bool Get(int _index) const
+	{
+		_ASSERT((_index >= 0) && (_index < numBits));
+		return ((words[_index / BITS_PER_WORD] >> (_index % BITS_PER_WORD)) & 1) != 0;
+	}
+
+	void Set(int _index, bool _value)
+	{
+		_ASSERT((_index >= 0) && (_index < numBits));
+		BitWord mask = (BitWord)1 << (_index % BITS_PER_WORD);
+		if (_value) {
+			words[_index / BITS_PER_WORD] |= mask;
+		} else {
+			words[_index / BITS_PER_WORD] &= ~mask;
+		}
+	}
+
+	int GetNumBits() const {return numBits;}
+	int GetNumWords() const {return (int)words.size();}
+	BitWord GetWord(int _wordIndex) const {return words[_wordIndex];}
+	void SetWord(int _wordIndex, BitWord _word) {words[_wordIndex] = _word;}
+
+private:
+
+	int numBits;
+	std::vector<BitWord> words;
+};
@@ -1,3 +1,5 @@
+#include <crtdbg.h>
+#include <string.h>
 #include "Cell.h"
 #include "Column.h"
 #include "Region.h"
@@ -5,6 +7,61 @@
 
 extern MemManager mem_manager;
 
+CellStateBuffers::CellStateBuffers()
+{
+	Current = Previous = NULL;
+	CurrentSteps = PreviousSteps = NULL;
+	allTouched[0] = allTouched[1] = false;
+	current = 0;
+}
+
+/// Set the number of cells, with every state inactive.
+void CellStateBuffers::Resize(int _numCells)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		// The states are followed by 3 bytes of padding, so that the state of any cell may be read as a 32 bit word (see Segment::ProcessSegment()).
+		states[i].assign(Max(1, _numCells) + 3, 0);
+		steps[i].assign(Max(1, _numCells), 0);
+		touched[i].clear();
+		allTouched[i] = false;
+	}
+
+	current = 0;
+	Current = &(states[0][0]);
+	CurrentSteps = &(steps[0][0]);
+	Previous = &(states[1][0]);
+	PreviousSteps = &(steps[1][0]);
+}
+
+/// Make the current states the previous states, and reset the current states to inactive.
+void CellStateBuffers::Advance()
+{
+	current = 1 - current;
+	Previous = Current;
+	PreviousSteps = CurrentSteps;
+	Current = &(states[current][0]);
+	CurrentSteps = &(steps[current][0]);
+
+	// Reset the entries that were set when this buffer was last current.
+	if (allTouched[current])
+	{
+		memset(Current, 0, states[current].size());
+		memset(CurrentSteps, 0, steps[current].size());
+		allTouched[current] = false;
+	}
+	else
+	{
+		for (std::vector<int>::const_iterator cell_iter = touched[current].begin(), end = touched[current].end(); cell_iter != end; ++cell_iter)
+		{
+			Current[*cell_iter] = 0;
+			CurrentSteps[*cell_iter] = 0;
+		}
+	}
+
+	touched[current].clear();
+}
+
 Cell::Cell(void)
 {
 }
@@ -16,10 +73,10 @@ Cell::~Cell(void)
 void Cell::Retire()
 {
 	// Release all Segments.
-	Segment *segment;
-	while ((segment = (Segment*)(Segments.RemoveFirst())) != NULL) {
-		mem_manager.ReleaseObject(segment);
-	}
+	ReleaseSegments();
+
+	// The segments that took input from this cell have been released by their own cells (see Region::~Region()).
+	_ASSERT(OutputSegments.empty());
 
 	// Release all SegmentsUpdateInfo objects.
 	SegmentUpdateInfo *segmentUpdateInfo;
@@ -30,28 +87,28 @@ void Cell::Retire()
 
 void Cell::SetIsActive(bool value) 
 {
-	IsActive = value;
+	SetStateFlag(CELL_STATE_ACTIVE, value);
 
 	// Record this cells's latest time being active.
-	if (IsActive) {
+	if (value) {
 		PrevActiveTime = column->region->GetStepCounter();
 	}
 }
 
 void Cell::SetIsPredicting(bool value, int numPredictionSteps)
 {
-	if (value && !_isPredicting)
+	if (value && !GetIsPredicting())
 	{
 		// This call is for the first segment found active, to make this cell predictive. Adopt that segment's NumPredictionSteps.
-		NumPredictionSteps = numPredictionSteps;
+		SetNumPredictionSteps(numPredictionSteps);
 	}
 	else
 	{
 		// This call is not for the firt active segment found; use the lower NumPredictionSteps between the segment's given value and the stored value.
-		NumPredictionSteps = Min(NumPredictionSteps, numPredictionSteps);
+		SetNumPredictionSteps(Min(GetNumPredictionSteps(), numPredictionSteps));
 	}
 
-	_isPredicting = value;
+	SetStateFlag(CELL_STATE_PREDICTING, value);
 }
 
 /// Methods
@@ -64,39 +121,59 @@ void Cell::Initialize(Column *col, int index)
 {
 	column = col;
 	Index = index;
-	IsActive = false;
-	WasActive = false;
-	_isPredicting = false;
-	WasPredicted = false;
-	IsLearning = false;
-	WasLearning = false;
-	NumPredictionSteps = 0;
-	PrevNumPredictionSteps = 0;
+	Number = (col->Index * col->region->CellsPerCol) + index;
+	States = &(col->region->CellStates);
 	PrevActiveTime = -1;
 }
 
-/// Advances this cell to the next time step. 
-/// 
-/// The current state of this cell (active, learning, predicting) will be set as the
-/// previous state and the current state will be reset to no cell activity by 
-/// default until it can be determined.
-void Cell::NextTimeStep()
+/// Gives this cell the new state determined by its frozen Region (see Region::Freeze()), in which it is 
+/// never learning. Its state is set without being touched; the Region calls CellStateBuffers::TouchAll().
+void Cell::SetFrozenState(bool _active, bool _predicting, bool _segmentPredicting, int _numPredictionSteps)
 {
-	WasPredicted = _isPredicting;
-	WasSegmentPredicted = IsSegmentPredicting;
-	WasActive = IsActive;
-	WasLearning = IsLearning;
-	_isPredicting = false;
-	IsSegmentPredicting = false;
-	IsActive = false;
-	IsLearning = false;
-	PrevNumPredictionSteps = NumPredictionSteps;
-	NumPredictionSteps = 0;
+	States->Current[Number] = (_active ? CELL_STATE_ACTIVE : 0) | (_predicting ? CELL_STATE_PREDICTING : 0) | (_segmentPredicting ? CELL_STATE_SEGMENT_PREDICTING : 0);
+	States->CurrentSteps[Number] = (unsigned char)_numPredictionSteps;
 
-	FastListIter segments_iter(Segments);
-	for (Segment *seg = (Segment*)(segments_iter.Reset()); seg != NULL; seg = (Segment*)(segments_iter.Advance()))
+	// Record this cells's latest time being active.
+	if (_active) {
+		PrevActiveTime = column->region->GetStepCounter();
+	}
+}
+
+/// Touch each of this active cell's OutputSegments (see Segment::Touch()). Each segment that is touched
+/// for the first time in the time step is added to _touchedSegments.
+void Cell::ActivateOutputSegments(std::vector<Segment*> &_touchedSegments)
+{
+	for (int i = 0; i < (int)OutputSegments.size(); i++)
 	{
-		seg->NextTimeStep();
+		if (OutputSegments[i]->Touch()) {
+			_touchedSegments.push_back(OutputSegments[i]);
+		}
+	}
+}
+
+/// Remove the given segment from this cell's list of OutputSegments, moving the last segment in the list into its place.
+/// The list is searched, since segments only lose synapses when they are pruned.
+void Cell::RemoveOutputSegment(Segment *_segment)
+{
+	for (int i = 0; i < (int)OutputSegments.size(); i++)
+	{
+		if (OutputSegments[i] == _segment)
+		{
+			OutputSegments[i] = OutputSegments.back();
+			OutputSegments.pop_back();
+			return;
+		}
+	}
+
+	_ASSERT(false);
+}
+
+/// Release all of this cell's distal segments.
+void Cell::ReleaseSegments()
+{
+	Segment *segment;
+	while ((segment = (Segment*)(Segments.RemoveFirst())) != NULL) {
+		mem_manager.ReleaseObject(segment);
 	}
 }
 
@@ -107,11 +184,11 @@ void Cell::NextTimeStep()
 /// The new segment will initially connect to at most newSynapseCount 
 /// synapses randomly selected from the set of cells that
 /// were in the learning state at t-1 (specified by the learningCells parameter).
-Segment *Cell::CreateSegment(FastList &learningCells, int creationTime)
+Segment *Cell::CreateSegment(std::vector<Cell*> &learningCells, int creationTime)
 {
 	Segment *newSegment = (Segment*)(mem_manager.GetObject(MOT_SEGMENT));
-	newSegment->Initialize(creationTime, (float)(column->region->SegActiveThreshold));
-	newSegment->CreateSynapsesToLearningCells(learningCells, &(column->region->DistalSynapseParams));
+	newSegment->Initialize(this, column->region->GetEpochCounter(), creationTime, (float)(column->region->SegActiveThreshold));
+	newSegment->CreateSynapsesToLearningCells(learningCells);
 	Segments.InsertAtEnd(newSegment);
 	return newSegment;
 }
@@ -169,14 +246,8 @@ Segment *Cell::GetPreviousActiveSegment()
 /// method is later called on this Cell.
 SegmentUpdateInfo *Cell::UpdateSegmentActiveSynapses(bool previous, Segment *segment, bool newSynapses, UpdateType updateType)
 {
-	FastList *activeSyns = NULL;
-	if (segment != NULL)
-	{
-		activeSyns = previous ? &(segment->PrevActiveSynapses) : &(segment->ActiveSynapses);
-	}
-
 	SegmentUpdateInfo *segmentUpdate = (SegmentUpdateInfo*)(mem_manager.GetObject(MOT_SEGMENT_UPDATE_INFO));
-	segmentUpdate->Initialize(this, segment, activeSyns, newSynapses, column->region->GetStepCounter(), updateType);
+	segmentUpdate->Initialize(this, segment, previous, newSynapses, column->region->GetStepCounter(), updateType);
 	_segmentUpdates.InsertAtEnd(segmentUpdate);
 	return segmentUpdate;
 }
@@ -197,9 +268,8 @@ void Cell::ApplySegmentUpdates(int _curTime, ApplyUpdateTrigger _trigger)
 {
 	Segment *segment;
 	SegmentUpdateInfo *segInfo;
-	Synapse *syn;
 	FastList modifiedSegments;
-	FastListIter synapses_iter, seg_update_iter;
+	FastListIter seg_update_iter;
 	bool apply_update;
 
 	// Iterate through all segment updates, skipping those not to be applied now, and removing those that are applied.
@@ -226,12 +296,12 @@ void Cell::ApplySegmentUpdates(int _curTime, ApplyUpdateTrigger _trigger)
 				if (_trigger == AUT_ACTIVE)
 				{
 					// The cell has become actve; positively reinforce the segment.
-					segment->UpdatePermanences(segInfo->ActiveDistalSynapses);
+					segment->UpdatePermanences(segInfo->ActiveSynapseCells, column->region->SynapseCellMarks);
 				}
 				else
 				{
 					// The cell has become inactive of is predictive but with a longer prediction. Negatively reinforce the segment.
-					segment->DecreasePermanences(segInfo->ActiveDistalSynapses);
+					segment->DecreasePermanences(segInfo->ActiveSynapseCells, column->region->SynapseCellMarks);
 				}
 
 				// Record that this segment has been modified, so it can later be checked for synapses that should be removed.
@@ -245,15 +315,15 @@ void Cell::ApplySegmentUpdates(int _curTime, ApplyUpdateTrigger _trigger)
 			{
 				if (segment == NULL)
 				{
-					if (segInfo->CellsThatWillLearn.Count() > 0) //only add if learning cells available
+					if (segInfo->CellsThatWillLearn.size() > 0) //only add if learning cells available
 					{
 						segment = segInfo->CreateCellSegment(column->region->GetStepCounter());
 					}
 				}
-				else if (segInfo->CellsThatWillLearn.Count() > 0)
+				else if (segInfo->CellsThatWillLearn.size() > 0)
 				{
 					//add new synapses to existing segment
-					segInfo->CreateSynapsesToLearningCells(&(column->region->DistalSynapseParams));
+					segInfo->CreateSynapsesToLearningCells();
 				}
 			}
 
@@ -281,27 +351,10 @@ void Cell::ApplySegmentUpdates(int _curTime, ApplyUpdateTrigger _trigger)
 			modifiedSegments.RemoveFirst();
 
 			// Remove from the current modified segment any synapses that have reached permanence of 0.
-			synapses_iter.SetList(segment->Synapses);
-			for (syn = (Synapse*)(synapses_iter.Reset()); syn != NULL;)
-			{
-				if (syn->GetPermanence() == 0.0f)
-				{
-					// Remove and release the current synapse, whose permanence has reached 0.
-					synapses_iter.Remove();
-					mem_manager.ReleaseObject(syn);
-
-					// Removing the synapse has advanced the iterator to the next synapse. Get a pointer to it.
-					syn = (Synapse*)(synapses_iter.Get());
-				}
-				else
-				{
-					// Advance to the next synapse.
-					syn = (Synapse*)(synapses_iter.Advance());
-				}
-			}
+			segment->RemoveZeroPermanenceSynapses();
 
 			// If this modified segment now has no synapses, remove the segment from this cell.
-			if (segment->Synapses.Count() == 0)
+			if (segment->GetNumDistalSynapses() == 0)
 			{
 				Segments.Remove(segment, false);
 				mem_manager.ReleaseObject(segment);
@@ -331,7 +384,7 @@ void Cell::ApplySegmentUpdates(int _curTime, ApplyUpdateTrigger _trigger)
 /// If no segments are found, then None is returned.
 Segment *Cell::GetBestMatchingPreviousSegment()
 {
-	return GetBestMatchingSegment(NumPredictionSteps + 1, true);
+	return GetBestMatchingSegment(GetNumPredictionSteps() + 1, true);
 }
 
 /// Gets the best matching Segment.
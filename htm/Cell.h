@@ -1,10 +1,53 @@
 #pragma once
+#include <vector>
 #include "MemObject.h"
 #include "Segment.h"
 #include "SegmentUpdateInfo.h"
 
 class Column;
 
+/// The flags making up a Cell's state, as recorded for each cell in its Region's CellStates.
+enum CellStateFlags
+{
+	CELL_STATE_ACTIVE = 1,
+	CELL_STATE_LEARNING = 2,
+	CELL_STATE_PREDICTING = 4,
+	CELL_STATE_SEGMENT_PREDICTING = 8
+};
+
+/// The states of all of a Region's cells, numbered (ColIndex * CellsPerCol) + cellIndex, during the current and
+/// the previous time step. Each cell's state is a combination of CellStateFlags, with its number of prediction
+/// steps kept alongside. Advancing to the next time step swaps the two buffers, and then resets only those 
+/// entries of the new current buffer that were set during the step before last.
+class CellStateBuffers
+{
+public:
+	CellStateBuffers();
+
+	/// The states and numbers of prediction steps of the cells, during the current and the previous time step.
+	unsigned char *Current, *Previous;
+	unsigned char *CurrentSteps, *PreviousSteps;
+
+	/// Set the number of cells, with every state inactive.
+	void Resize(int _numCells);
+
+	/// Make the current states the previous states, and reset the current states to inactive.
+	void Advance();
+
+	/// Record that the current state of the given cell is being set, so that it will be reset by Advance(). 
+	void Touch(int _cellNumber) {touched[current].push_back(_cellNumber);}
+
+	/// Record that the current states of all cells may have been set, without their having been touched.
+	void TouchAll() {allTouched[current] = true;}
+
+private:
+
+	std::vector<unsigned char> states[2], steps[2];
+	std::vector<int> touched[2];
+	bool allTouched[2];
+	int current;
+};
+
 /// A data structure representing a single context sensitive cell.
 class Cell :
 	public MemObject
@@ -20,55 +63,79 @@ public:
 
 private:
 
-	int Index, NumPredictionSteps, PrevNumPredictionSteps, PrevActiveTime;
-	bool IsActive, WasActive, IsLearning, WasLearning, _isPredicting;
-	bool IsSegmentPredicting, WasSegmentPredicted, WasPredicted;
+	int Index, Number, PrevActiveTime;
 	Column *column;
 
+	// The buffers of the Region's cell states, where this cell's state is kept at index Number.
+	CellStateBuffers *States;
+
 	void SetColumn(Column *value) {column = value;}
 
-	void SetNumPredictionSteps(int value) {NumPredictionSteps = value;}
+	void SetNumPredictionSteps(int value) {States->CurrentSteps[Number] = (unsigned char)value;}
+
+	/// Set or clear one of the flags of this cell's current state.
+	void SetStateFlag(unsigned char _flag, bool _value)
+	{
+		unsigned char &state = States->Current[Number];
+
+		if (_value)
+		{
+			if (state == 0) {
+				States->Touch(Number);
+			}
+			state |= _flag;
+		}
+		else
+		{
+			state &= ~_flag;
+		}
+	}
 
 public:
 
 	FastList Segments;
 	FastList _segmentUpdates;
 
+	/// The distal segments, of any of the Region's cells, that have a synapse taking its input from this
+	/// cell. Lets the segments with active synapses be found by visiting only the active cells.
+	std::vector<Segment*> OutputSegments;
+
 	/// Position in Column
 	int GetIndex() {return Index;}
 	void SetIndex(int value) {Index = value;}
 
+	/// This Cell's number within its Region: (ColIndex * CellsPerCol) + Index.
+	int GetNumber() {return Number;}
+
 	/// Gets or sets a value indicating whether this Cell is active.
 	///   true if this instance is active; otherwise, false.
-	bool GetIsActive() {return IsActive;}
+	bool GetIsActive() {return (States->Current[Number] & CELL_STATE_ACTIVE) != 0;}
 	void SetIsActive(bool value);
 
 	/// Gets a value indicating whether this Cell was active.
 	///   true if it was active; otherwise, false.
-	bool GetWasActive() {return WasActive;}
-	void SetWasActive(bool value) {WasActive = value;}
+	bool GetWasActive() {return (States->Previous[Number] & CELL_STATE_ACTIVE) != 0;}
 
 	/// Gets or sets a value indicating whether this Cell is learning.
 	/// true if it is learning; otherwise, false.
-	bool GetIsLearning() {return IsLearning;}
-	void SetIsLearning(bool value) {IsLearning = value;}
+	bool GetIsLearning() {return (States->Current[Number] & CELL_STATE_LEARNING) != 0;}
+	void SetIsLearning(bool value) {SetStateFlag(CELL_STATE_LEARNING, value);}
 
 	/// Gets a value indicating whether this Cell was learning.
 	///   true if it was learning; otherwise, false.
-	bool GetWasLearning() {return WasLearning;}
-	void SetWasLearning(bool value) {WasLearning = value;}
+	bool GetWasLearning() {return (States->Previous[Number] & CELL_STATE_LEARNING) != 0;}
 
-	bool GetIsPredicting() {return _isPredicting;}
+	bool GetIsPredicting() {return (States->Current[Number] & CELL_STATE_PREDICTING) != 0;}
 	void SetIsPredicting(bool value, int numPredictionSteps);
 
-	bool GetIsSegmentPredicting() {return IsSegmentPredicting;}
-	void SetIsSegmentPredicting(bool value) {IsSegmentPredicting = value;}
+	bool GetIsSegmentPredicting() {return (States->Current[Number] & CELL_STATE_SEGMENT_PREDICTING) != 0;}
+	void SetIsSegmentPredicting(bool value) {SetStateFlag(CELL_STATE_SEGMENT_PREDICTING, value);}
 
 	/// Indicates whether this cell was predicted to become active.
-	bool GetWasPredicted() {return WasPredicted;}
+	bool GetWasPredicted() {return (States->Previous[Number] & CELL_STATE_PREDICTING) != 0;}
 
-	int GetNumPredictionSteps() {return NumPredictionSteps;}
-	int GetPrevNumPredictionSteps() {return PrevNumPredictionSteps;}
+	int GetNumPredictionSteps() {return States->CurrentSteps[Number];}
+	int GetPrevNumPredictionSteps() {return States->PreviousSteps[Number];}
 
 	int GetPrevActiveTme() {return PrevActiveTime;}
 
@@ -80,12 +147,20 @@ public:
 	/// integer id to distinguish this Cell from others in the Column.
 	void Initialize(Column *col, int intdx);
 
-	/// Advances this cell to the next time step. 
-	/// 
-	/// The current state of this cell (active, learning, predicting) will be set as the
-	/// previous state and the current state will be reset to no cell activity by 
-	/// default until it can be determined.
-	void NextTimeStep();
+	/// Gives this cell the new state determined by its frozen Region (see Region::Freeze()), in which it is 
+	/// never learning. Its state is set without being touched; the Region calls CellStateBuffers::TouchAll().
+	void SetFrozenState(bool _active, bool _predicting, bool _segmentPredicting, int _numPredictionSteps);
+
+	/// Touch each of this active cell's OutputSegments (see Segment::Touch()). Each segment that is touched
+	/// for the first time in the time step is added to _touchedSegments.
+	void ActivateOutputSegments(std::vector<Segment*> &_touchedSegments);
+
+	/// Add the given segment to, or remove it from, this cell's list of OutputSegments.
+	void AddOutputSegment(Segment *_segment) {OutputSegments.push_back(_segment);}
+	void RemoveOutputSegment(Segment *_segment);
+
+	/// Release all of this cell's distal segments.
+	void ReleaseSegments();
 
 	/// Creates a new segment for this Cell.
 	/// learningCells: A set of available learning cells to add to the segmentUpdateList.
@@ -94,7 +169,7 @@ public:
 	/// The new segment will initially connect to at most newSynapseCount 
 	/// synapses randomly selected from the set of cells that
 	/// were in the learning state at t-1 (specified by the learningCells parameter).
-	Segment *CreateSegment(FastList &learningCells, int creationTime);
+	Segment *CreateSegment(std::vector<Cell*> &learningCells, int creationTime);
 
 	/// For this cell, return a Segment that was active in the previous
 	/// time step. If multiple segments were active, sequence segments are given
@@ -1,6 +1,7 @@
+#include <crtdbg.h>
 #include "Classifier.h"
 
-Classifier::Classifier(QString &_id, int _numItems, QString _regionID, QString _inputspaceID, QStringList &_labels)
+Classifier::Classifier(const std::string &_id, int _numItems, const std::string &_regionID, const std::string &_inputspaceID, std::vector<std::string> &_labels)
 	: DataSpace(_id), labels(_labels), regionID(_regionID), inputspaceID(_inputspaceID), numItems(_numItems)
 {
 }
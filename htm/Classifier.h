@@ -1,5 +1,5 @@
 #pragma once
-#include <QtCore/QStringList>
+#include <vector>
 #include "DataSpace.h"
 
 class InputSpace;
@@ -9,16 +9,16 @@ class Classifier
 	: public DataSpace
 {
 public:
-	Classifier(QString &_id, int _numitems, QString _regionID, QString _inputspaceID, QStringList &_labels);
+	Classifier(const std::string &_id, int _numitems, const std::string &_regionID, const std::string &_inputspaceID, std::vector<std::string> &_labels);
 	~Classifier(void) {};
 
 	// Properties
 
-	QString regionID, inputspaceID;
+	std::string regionID, inputspaceID;
 	InputSpace *inputspace;
 	Region *region;
 	int numItems;
-	QStringList labels;
+	std::vector<std::string> labels;
 
 	// Methods
 
@@ -2,9 +2,13 @@
 #include <stdlib.h>
 #include <random>
 #include <limits.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
 #include "Cell.h"
 #include "Segment.h"
 #include "Synapse.h"
+#include "ProximalSynapse.h"
 #include "Region.h"
 #include "InputSpace.h"
 #include "Utils.h"
@@ -24,6 +28,20 @@ Column::~Column(void)
 	}
 
 	delete [] Cells;
+
+	delete [] ReceptiveFieldDistances;
+	delete [] ConnectedCountAtDistance;
+
+	delete [] ProximalSynapses;
+	delete [] ProximalConnected;
+	delete [] ProximalInputBits;
+	delete [] ProximalInputValues;
+	delete [] ProximalInputActive;
+	delete [] ProximalPermanences;
+	delete [] ProximalPermanences16;
+	delete [] ProximalPermanences8;
+	delete [] ProximalWellConnected;
+	delete [] ProximalActiveCounts;
 }
 
 // Methods
@@ -42,14 +60,31 @@ Column::Column(Region *_region, Point pos, int minOverlapToReuseSegment)
 
 	IsActive = false;
 	IsInhibited = false;
-	ActiveDutyCycle = 1;
-	FastActiveDutyCycle = 1;
-	_overlapDutyCycle = 1.0f;
 	maxDutyCycle = 0.0f;
 	Overlap = 0;
 	prevBoostTime = 0;
 	DesiredLocalActivity = 0;
 	MinOverlapToReuseSegment = minOverlapToReuseSegment;
+	ReceptiveFieldDistances = NULL;
+	ConnectedCountAtDistance = NULL;
+	NumReceptiveFieldDistances = 0;
+	ReceptiveFieldDistanceIndex = -1;
+	ActiveConnectedSynapsesCount = 0;
+	ActiveWellConnectedSynapsesCount = 0;
+	WellConnectedSynapsesCount = 0;
+	NumProximalSynapses = 0;
+	ProximalSynapses = NULL;
+	ProximalPermanences = NULL;
+	ProximalPermanences16 = NULL;
+	ProximalPermanences8 = NULL;
+	ProximalWellConnected = NULL;
+	ProximalConnected = NULL;
+	ProximalInputBits = NULL;
+	ProximalInputValues = NULL;
+	ProximalInputActive = NULL;
+	ProximalActiveCounts = NULL;
+	LearningStepCount = 0;
+	ProximalPermanencesChanged = false;
 
 	// Determine initial random low Boost value, just to break ties between columns with the same amount of overlap.
 	// The initial Boost value is set to be the same as this Column's MinBoost value.
@@ -58,6 +93,9 @@ Column::Column(Region *_region, Point pos, int minOverlapToReuseSegment)
 	// Determine this Column's MaxBoost value, with random variation to avoid ties between fully boosted Columns.
 	MaxBoost = (region->GetMaxBoost() == -1) ? -1 : region->GetMaxBoost() - ((float)rand() / (float)RAND_MAX) * BoostVariance;
 
+	// Record Position and determine HypercolumnPosition. This gives the Column the Index that its Cells are numbered by.
+	SetPosition(pos);
+
 	// Create each of this Column's Cells.
 	Cells = new Cell*[region->CellsPerCol];
 	Cell *newCell;
@@ -70,15 +108,13 @@ Column::Column(Region *_region, Point pos, int minOverlapToReuseSegment)
 
 	// The list of potential proximal synapses and their permanence values.
 	ProximalSegment = (Segment*)(mem_manager.GetObject(MOT_SEGMENT));
-	ProximalSegment->Initialize(0, (float)(region->SegActiveThreshold));
-
-	// Record Position and determine HypercolumnPosition.
-	SetPosition(pos);
+	ProximalSegment->Initialize(NULL, region->GetEpochCounter(), 0, (float)(region->SegActiveThreshold));
 }
 
 void  Column::SetPosition(Point value) 
 {
 	Position = value; 
+	Index = (value.Y * region->GetSizeX()) + value.X;
 	HypercolumnPosition = Point((int)(value.X / region->GetHypercolumnDiameter()), (int)(value.Y / region->GetHypercolumnDiameter()));
 }
 
@@ -412,11 +448,10 @@ void Column::GetBestMatchingCell(int numPredictionSteps, bool previous, Cell* &b
 /// (Columns near the edges of the Region will have smaller input areas).
 void Column::ComputeOverlap()
 {
-	// Calculate number of active synapses on the proximal segment
-	ProximalSegment->ProcessSegment();
-
-	// Find "overlap", that is the current number of active and connected synapses
-	float overlap = ProximalSegment->GetActiveConnectedSynapseCount();
+	// Find "overlap", that is the current number of active and connected synapses. This has been 
+	// accumulated by the Region from the currently active input values.
+	float overlap = ActiveConnectedSynapsesCount;
+	int inactiveWellConnectedSynapsesCount = WellConnectedSynapsesCount - ActiveWellConnectedSynapsesCount;
 
 	if (overlap < _minOverlap)
 	{
@@ -430,7 +465,7 @@ void Column::ComputeOverlap()
 		// so that patterns with greater numbers of connected syanpses do not gain an advantage in representing all possible subpatterns.
 		// It only cares about strongly connected synapses, because weakly connected synapses can be the result of little or no learning, and we don't
 		// want to penalize matches that haven't had a chance to be refined by learning yet.
-		overlap = overlap * ((float)(ProximalSegment->GetActiveConnectedSynapseCount()) / (float)(ProximalSegment->GetActiveConnectedSynapseCount() + ProximalSegment->GetInactiveWellConnectedSynapsesCount())) * Boost;
+		overlap = overlap * ((float)(ActiveConnectedSynapsesCount) / (float)(ActiveConnectedSynapsesCount + inactiveWellConnectedSynapsesCount)) * Boost;
 	}
 
 	// Record the determined number as this Column's Overlap.
@@ -467,7 +502,7 @@ void Column::ComputeColumnInhibition()
 
 	if (Overlap > 0)
 	{
-		if (region->IsWithinKthScore(this, DesiredLocalActivity))
+		if (region->IsWithinKthScore(this))
 		{
 			IsActive = true;
 		}
@@ -478,39 +513,425 @@ void Column::ComputeColumnInhibition()
 	}
 }
 
+/// Returns true if this Column's overlap, without its Boost, is at least its MinOverlap.
+bool Column::HasMinOverlap()
+{
+	// CHANGED: Overlap is divided by Boost before being compared with _minOverlap, because _minOverlap doesn't have Boost factored into it. This makes them comparable.
+	return (Overlap / Boost) >= _minOverlap; // Note: Numenta docs indicate >, but given its function in boosting of trying to raise overlap to a number that allows activation (ie., minOverlap), >= makes more sense to me. 
+}
+
+// The proximal permanences may be stored as floats or as fixed point values (see PermanenceFormat). The
+// functions below perform each operation on an array of permanences of any of those types (see StoredPermanence()).
+
+/// Increase the permanence of each synapse whose input is active, and decrease the others, within [0, 1].
+/// Records whether each is well connected, and counts those that are and those whose connection has changed.
+/// This loop has no branches or calls, so that the compiler can vectorize it.
+template <class T>
+static void AdaptPermanenceValues(T *_perms, int _count, const unsigned char *_inputActive, SynapseParameters &_params, const unsigned char *_connected, unsigned char *_wellConnected, int &_wellConnectedCount, int &_connectionChangeCount)
+{
+	T permanenceInc = StoredPermanence<T>(_params, _params.PermanenceInc);
+	T permanenceDec = StoredPermanence<T>(_params, _params.PermanenceDec);
+	T connectedPerm = StoredPermanence<T>(_params, _params.ConnectedPerm);
+	T initialPermanence = StoredPermanence<T>(_params, _params.InitialPermanence);
+	T maxPerm = StoredPermanence<T>(_params, 1.0f);
+	typename PermanenceSum<T>::Type perm;
+
+	for (int i = 0; i < _count; i++)
+	{
+		perm = _perms[i] + (_inputActive[i] ? permanenceInc : -permanenceDec);
+		perm = Min(maxPerm, Max(0, perm));
+		_perms[i] = (T)perm;
+		_wellConnected[i] = (perm > initialPermanence) ? 1 : 0;
+		_wellConnectedCount += _wellConnected[i];
+		_connectionChangeCount += (((perm >= connectedPerm) ? 1 : 0) != _connected[i]) ? 1 : 0;
+	}
+}
+
+/// Apply the net result of _numSteps learning steps to each permanence, during _activeCounts[i] of which its
+/// input was active, keeping it within [0, 1]. Records whether each is well connected, and counts those that are
+/// and those whose connection has changed.
+template <class T>
+static void ApplyPermanenceDeltas(T *_perms, int _count, const unsigned short *_activeCounts, int _numSteps, SynapseParameters &_params, const unsigned char *_connected, unsigned char *_wellConnected, int &_wellConnectedCount, int &_connectionChangeCount)
+{
+	typename PermanenceSum<T>::Type permanenceInc = StoredPermanence<T>(_params, _params.PermanenceInc);
+	typename PermanenceSum<T>::Type permanenceDec = StoredPermanence<T>(_params, _params.PermanenceDec);
+	T connectedPerm = StoredPermanence<T>(_params, _params.ConnectedPerm);
+	T initialPermanence = StoredPermanence<T>(_params, _params.InitialPermanence);
+	T maxPerm = StoredPermanence<T>(_params, 1.0f);
+	typename PermanenceSum<T>::Type perm, totalDec = permanenceDec * _numSteps;
+
+	for (int i = 0; i < _count; i++)
+	{
+		perm = _perms[i] + (_activeCounts[i] * (permanenceInc + permanenceDec)) - totalDec;
+		perm = Min(maxPerm, Max(0, perm));
+		_perms[i] = (T)perm;
+		_wellConnected[i] = (perm > initialPermanence) ? 1 : 0;
+		_wellConnectedCount += _wellConnected[i];
+		_connectionChangeCount += (((perm >= connectedPerm) ? 1 : 0) != _connected[i]) ? 1 : 0;
+	}
+}
+
+/// Move each permanence toward ConnectedPerm by the given amount, without passing it. Records whether each
+/// is well connected, and counts those that are and those whose connection has changed.
+template <class T>
+static void BoostPermanenceValues(T *_perms, int _count, float _amount, SynapseParameters &_params, const unsigned char *_connected, unsigned char *_wellConnected, int &_wellConnectedCount, int &_connectionChangeCount)
+{
+	T amount = StoredPermanence<T>(_params, _amount);
+	T connectedPerm = StoredPermanence<T>(_params, _params.ConnectedPerm);
+	T initialPermanence = StoredPermanence<T>(_params, _params.InitialPermanence);
+	typename PermanenceSum<T>::Type perm;
+
+	for (int i = 0; i < _count; i++)
+	{
+		perm = _perms[i];
+		perm = (perm < connectedPerm) ? Min(connectedPerm, perm + amount) : ((perm > connectedPerm) ? Max(connectedPerm, perm - amount) : perm);
+		_perms[i] = (T)perm;
+		_wellConnected[i] = (perm > initialPermanence) ? 1 : 0;
+		_wellConnectedCount += _wellConnected[i];
+		_connectionChangeCount += (((perm >= connectedPerm) ? 1 : 0) != _connected[i]) ? 1 : 0;
+	}
+}
+
+/// Lower any permanence above ConnectedPerm to exactly ConnectedPerm.
+template <class T>
+static void LimitPermanenceValues(T *_perms, int _count, SynapseParameters &_params)
+{
+	T connectedPerm = StoredPermanence<T>(_params, _params.ConnectedPerm);
+
+	for (int i = 0; i < _count; i++) {
+		_perms[i] = Min(_perms[i], connectedPerm);
+	}
+}
+
+/// Record whether each permanence is well connected (above InitialPermanence), and return the number that are.
+template <class T>
+static int CountWellConnectedValues(const T *_perms, int _count, SynapseParameters &_params, unsigned char *_wellConnected)
+{
+	T initialPermanence = StoredPermanence<T>(_params, _params.InitialPermanence);
+	int wellConnectedCount = 0;
+
+	for (int i = 0; i < _count; i++)
+	{
+		_wellConnected[i] = (_perms[i] > initialPermanence) ? 1 : 0;
+		wellConnectedCount += _wellConnected[i];
+	}
+
+	return wellConnectedCount;
+}
+
 /// Update the permanence value of every synapse in this column based on whether active.
 /// This is the main learning rule (for the column's proximal dentrite). 
 /// For winning columns, if a synapse is active, its permanence value is incremented, 
 /// otherwise it is decremented. Permanence values are constrained to be between 0 and 1.
 void Column::AdaptPermanences()
 {
-	ProximalSegment->AdaptPermanences();
+	SynapseParameters &params = region->ProximalSynapseParams;
+	int i, wellConnectedCount = 0, connectionChangeCount = 0;
+
+	// Gather whether each synapse's input is active.
+	for (i = 0; i < NumProximalSynapses; i++) {
+		ProximalInputActive[i] = ProximalInputBits[i]->Get(ProximalInputValues[i]) ? 1 : 0;
+	}
+
+	// Increase or decrease each permanence, and recount the well connected synapses.
+	switch (params.Format)
+	{
+	case PERMANENCE_FORMAT_16BIT:
+		AdaptPermanenceValues(ProximalPermanences16, NumProximalSynapses, ProximalInputActive, params, ProximalConnected, ProximalWellConnected, wellConnectedCount, connectionChangeCount);
+		break;
+	case PERMANENCE_FORMAT_8BIT:
+		AdaptPermanenceValues(ProximalPermanences8, NumProximalSynapses, ProximalInputActive, params, ProximalConnected, ProximalWellConnected, wellConnectedCount, connectionChangeCount);
+		break;
+	default:
+		AdaptPermanenceValues(ProximalPermanences, NumProximalSynapses, ProximalInputActive, params, ProximalConnected, ProximalWellConnected, wellConnectedCount, connectionChangeCount);
+		break;
+	}
+
+	WellConnectedSynapsesCount = wellConnectedCount;
+	ProximalPermanencesChanged = true;
+
+	// Keep the receptive field size up to date as synapses cross ConnectedPerm.
+	if (connectionChangeCount > 0) {
+		UpdateProximalConnections();
+	}
+}
+
+/// Record which of this Column's proximal synapses are active, for the learning step that will be applied
+/// to their permanences by ApplyAccumulatedLearning() at the end of the SpatialLearningWindow.
+void Column::AccumulateLearning()
+{
+	for (int i = 0; i < NumProximalSynapses; i++) {
+		ProximalActiveCounts[i] += ProximalInputBits[i]->Get(ProximalInputValues[i]) ? 1 : 0;
+	}
+
+	LearningStepCount++;
+}
+
+/// Apply to the permanences the net result of the learning steps accumulated since this was last called,
+/// as AdaptPermanences() would have over those steps (apart from being kept within [0, 1] only once).
+void Column::ApplyAccumulatedLearning()
+{
+	if (LearningStepCount == 0) {
+		return;
+	}
+
+	SynapseParameters &params = region->ProximalSynapseParams;
+	int wellConnectedCount = 0, connectionChangeCount = 0;
+
+	switch (params.Format)
+	{
+	case PERMANENCE_FORMAT_16BIT:
+		ApplyPermanenceDeltas(ProximalPermanences16, NumProximalSynapses, ProximalActiveCounts, LearningStepCount, params, ProximalConnected, ProximalWellConnected, wellConnectedCount, connectionChangeCount);
+		break;
+	case PERMANENCE_FORMAT_8BIT:
+		ApplyPermanenceDeltas(ProximalPermanences8, NumProximalSynapses, ProximalActiveCounts, LearningStepCount, params, ProximalConnected, ProximalWellConnected, wellConnectedCount, connectionChangeCount);
+		break;
+	default:
+		ApplyPermanenceDeltas(ProximalPermanences, NumProximalSynapses, ProximalActiveCounts, LearningStepCount, params, ProximalConnected, ProximalWellConnected, wellConnectedCount, connectionChangeCount);
+		break;
+	}
+
+	WellConnectedSynapsesCount = wellConnectedCount;
+	ProximalPermanencesChanged = true;
+
+	if (connectionChangeCount > 0) {
+		UpdateProximalConnections();
+	}
+
+	// Begin the next window.
+	memset(ProximalActiveCounts, 0, NumProximalSynapses * sizeof(unsigned short));
+	LearningStepCount = 0;
 }
 
 /// Increase the permanence value of every unconnected proximal synapse in this column by the amount given.
 void Column::BoostPermanences(float amount)
 {
+	SynapseParameters &params = region->ProximalSynapseParams;
+	int wellConnectedCount = 0, connectionChangeCount = 0;
+
+	// Fixed point permanences are boosted by a whole number of steps.
+	amount = params.QuantizePermanenceAmount(amount);
+
+	// Move each permanence toward ConnectedPerm by the given amount, without passing it. A synapse boosted 
+	// all the way to ConnectedPerm becomes connected.
+	switch (params.Format)
+	{
+	case PERMANENCE_FORMAT_16BIT:
+		BoostPermanenceValues(ProximalPermanences16, NumProximalSynapses, amount, params, ProximalConnected, ProximalWellConnected, wellConnectedCount, connectionChangeCount);
+		break;
+	case PERMANENCE_FORMAT_8BIT:
+		BoostPermanenceValues(ProximalPermanences8, NumProximalSynapses, amount, params, ProximalConnected, ProximalWellConnected, wellConnectedCount, connectionChangeCount);
+		break;
+	default:
+		BoostPermanenceValues(ProximalPermanences, NumProximalSynapses, amount, params, ProximalConnected, ProximalWellConnected, wellConnectedCount, connectionChangeCount);
+		break;
+	}
+
+	WellConnectedSynapsesCount = wellConnectedCount;
+	ProximalPermanencesChanged = true;
+
+	if (connectionChangeCount > 0) {
+		UpdateProximalConnections();
+	}
+}
+
+/// Rebuild the arrays of proximal synapse state from the ProximalSegment's synapses. Called after
+/// the proximal synapses have been created or loaded.
+void Column::InitializeProximalSynapses()
+{
+	ProximalSynapse *pSyn;
+	int i;
+
+	delete [] ProximalSynapses;
+	delete [] ProximalConnected;
+	delete [] ProximalInputBits;
+	delete [] ProximalInputValues;
+	delete [] ProximalInputActive;
+	delete [] ProximalPermanences;
+	delete [] ProximalPermanences16;
+	delete [] ProximalPermanences8;
+	delete [] ProximalWellConnected;
+	delete [] ProximalActiveCounts;
+
+	NumProximalSynapses = ProximalSegment->Synapses.Count();
+	ProximalSynapses = new ProximalSynapse*[Max(1, NumProximalSynapses)];
+	ProximalConnected = new unsigned char[Max(1, NumProximalSynapses)];
+	ProximalInputBits = new const BitArray*[Max(1, NumProximalSynapses)];
+	ProximalInputValues = new int[Max(1, NumProximalSynapses)];
+	ProximalInputActive = new unsigned char[Max(1, NumProximalSynapses)];
+	ProximalWellConnected = new unsigned char[Max(1, NumProximalSynapses)];
+
+	// Allocate only the array of permanences for the format in which they are stored.
+	PermanenceFormat format = region->ProximalSynapseParams.Format;
+	ProximalPermanences = (format == PERMANENCE_FORMAT_FLOAT) ? new float[Max(1, NumProximalSynapses)] : NULL;
+	ProximalPermanences16 = (format == PERMANENCE_FORMAT_16BIT) ? new unsigned short[Max(1, NumProximalSynapses)] : NULL;
+	ProximalPermanences8 = (format == PERMANENCE_FORMAT_8BIT) ? new unsigned char[Max(1, NumProximalSynapses)] : NULL;
+
+	// Counts of active inputs are only needed if learning is applied once per window of several steps.
+	ProximalActiveCounts = (region->GetSpatialLearningWindow() > 1) ? new unsigned short[Max(1, NumProximalSynapses)] : NULL;
+	LearningStepCount = 0;
+
 	FastListIter synapses_iter(ProximalSegment->Synapses);
-	for (Synapse *syn = (Synapse*)(synapses_iter.Reset()); syn != NULL; syn = (Synapse*)(synapses_iter.Advance()))
+	for (pSyn = (ProximalSynapse*)(synapses_iter.Reset()), i = 0; pSyn != NULL; pSyn = (ProximalSynapse*)(synapses_iter.Advance()), i++)
 	{
-		if (syn->GetPermanence() < region->ProximalSynapseParams.ConnectedPerm) {
-			syn->IncreasePermanence(amount, region->ProximalSynapseParams.ConnectedPerm);
-		}
-		else if (syn->GetPermanence() > region->ProximalSynapseParams.ConnectedPerm) {
-			syn->DecreasePermanence(amount, region->ProximalSynapseParams.ConnectedPerm);
+		ProximalSynapses[i] = pSyn;
+		SetProximalPermanence(i, pSyn->GetPermanence());
+		ProximalConnected[i] = (GetProximalPermanence(i) >= region->ProximalSynapseParams.ConnectedPerm) ? 1 : 0;
+		ProximalInputBits[i] = pSyn->InputBits;
+		ProximalInputValues[i] = pSyn->InputValueIndex;
+		ProximalInputActive[i] = 0;
+		if (ProximalActiveCounts != NULL) ProximalActiveCounts[i] = 0;
+	}
+
+	ProximalPermanencesChanged = false;
+
+	CountWellConnectedSynapses();
+}
+
+/// Copy the permanences of the proximal synapses into the ProximalSynapse objects, if they have
+/// changed since last stored.
+void Column::StoreProximalPermanences()
+{
+	if (ProximalPermanencesChanged == false) {
+		return;
+	}
+
+	for (int i = 0; i < NumProximalSynapses; i++) {
+		ProximalSynapses[i]->SetPermanence(GetProximalPermanence(i));
+	}
+
+	ProximalPermanencesChanged = false;
+}
+
+float Column::GetProximalPermanence(int _index)
+{
+	switch (region->ProximalSynapseParams.Format)
+	{
+	case PERMANENCE_FORMAT_16BIT:
+		return region->ProximalSynapseParams.UnitsToPermanence(ProximalPermanences16[_index]);
+	case PERMANENCE_FORMAT_8BIT:
+		return region->ProximalSynapseParams.UnitsToPermanence(ProximalPermanences8[_index]);
+	default:
+		return ProximalPermanences[_index];
+	}
+}
+
+void Column::SetProximalPermanence(int _index, float _permanence)
+{
+	switch (region->ProximalSynapseParams.Format)
+	{
+	case PERMANENCE_FORMAT_16BIT:
+		ProximalPermanences16[_index] = (unsigned short)(region->ProximalSynapseParams.PermanenceToUnits(_permanence));
+		break;
+	case PERMANENCE_FORMAT_8BIT:
+		ProximalPermanences8[_index] = (unsigned char)(region->ProximalSynapseParams.PermanenceToUnits(_permanence));
+		break;
+	default:
+		ProximalPermanences[_index] = _permanence;
+		break;
+	}
+}
+
+/// Rebuild the record of how many connected proximal synapses this Column has at each distance
+/// from its inputs. Called after InitializeProximalSynapses().
+void Column::InitializeReceptiveField()
+{
+	ProximalSynapse *pSyn;
+	int i;
+
+	delete [] ReceptiveFieldDistances;
+	delete [] ConnectedCountAtDistance;
+
+	// Determine the distinct distances of the proximal synapses, in increasing order.
+	std::vector<float> distances;
+	for (i = 0; i < NumProximalSynapses; i++) {
+		distances.push_back(ProximalSynapses[i]->DistanceToInput);
+	}
+
+	std::sort(distances.begin(), distances.end());
+	distances.erase(std::unique(distances.begin(), distances.end()), distances.end());
+
+	NumReceptiveFieldDistances = (int)distances.size();
+	ReceptiveFieldDistances = new float[Max(1, NumReceptiveFieldDistances)];
+	ConnectedCountAtDistance = new int[Max(1, NumReceptiveFieldDistances)];
+
+	for (i = 0; i < NumReceptiveFieldDistances; i++) 
+	{
+		ReceptiveFieldDistances[i] = distances[i];
+		ConnectedCountAtDistance[i] = 0;
+	}
+
+	// Record each synapse's distance index, and count the connected synapses at each distance.
+	ReceptiveFieldDistanceIndex = -1;
+	for (i = 0; i < NumProximalSynapses; i++)
+	{
+		pSyn = ProximalSynapses[i];
+		pSyn->DistanceIndex = (int)(std::lower_bound(distances.begin(), distances.end(), pSyn->DistanceToInput) - distances.begin());
+
+		if (ProximalConnected[i]) 
+		{
+			ConnectedCountAtDistance[pSyn->DistanceIndex]++;
+			ReceptiveFieldDistanceIndex = Max(ReceptiveFieldDistanceIndex, pSyn->DistanceIndex);
 		}
 	}
 }
 
+/// Count the proximal synapses with permanence above InitialPermanence, and record which they are.
+void Column::CountWellConnectedSynapses()
+{
+	switch (region->ProximalSynapseParams.Format)
+	{
+	case PERMANENCE_FORMAT_16BIT:
+		WellConnectedSynapsesCount = CountWellConnectedValues(ProximalPermanences16, NumProximalSynapses, region->ProximalSynapseParams, ProximalWellConnected);
+		break;
+	case PERMANENCE_FORMAT_8BIT:
+		WellConnectedSynapsesCount = CountWellConnectedValues(ProximalPermanences8, NumProximalSynapses, region->ProximalSynapseParams, ProximalWellConnected);
+		break;
+	default:
+		WellConnectedSynapsesCount = CountWellConnectedValues(ProximalPermanences, NumProximalSynapses, region->ProximalSynapseParams, ProximalWellConnected);
+		break;
+	}
+}
 
-// Update running averages of activity and overlap.
-void Column::UpdateDutyCycles()
+/// Update ProximalConnected for any proximal synapses whose permanences have crossed ConnectedPerm,
+/// and the record of connected proximal synapses along with them.
+void Column::UpdateProximalConnections()
 {
-	maxDutyCycle = DetermineMaxDutyCycle();
-	
-	UpdateActiveDutyCycle();
+	float connectedPerm = region->ProximalSynapseParams.ConnectedPerm;
+	unsigned char connected;
 
-	UpdateOverlapDutyCycle();
+	for (int i = 0; i < NumProximalSynapses; i++)
+	{
+		connected = (GetProximalPermanence(i) >= connectedPerm) ? 1 : 0;
+
+		if (connected != ProximalConnected[i])
+		{
+			ProximalConnected[i] = connected;
+			ProximalSynapseConnectionChanged(i);
+		}
+	}
+}
+
+/// Update the record of connected proximal synapses after the synapse with the given index has become
+/// connected or disconnected.
+void Column::ProximalSynapseConnectionChanged(int _synapseIndex)
+{
+	int distanceIndex = ProximalSynapses[_synapseIndex]->DistanceIndex;
+
+	if (ProximalConnected[_synapseIndex])
+	{
+		ConnectedCountAtDistance[distanceIndex]++;
+		ReceptiveFieldDistanceIndex = Max(ReceptiveFieldDistanceIndex, distanceIndex);
+	}
+	else
+	{
+		ConnectedCountAtDistance[distanceIndex]--;
+
+		// If the furthest connected synapse was disconnected, find the next furthest distance with a connected synapse.
+		while ((ReceptiveFieldDistanceIndex >= 0) && (ConnectedCountAtDistance[ReceptiveFieldDistanceIndex] == 0)) {
+			ReceptiveFieldDistanceIndex--;
+		}
+	}
 }
 
 /// There are two separate boosting mechanisms in place to help a column learn connections. 
@@ -525,9 +946,11 @@ void Column::UpdateDutyCycles()
 /// to replace the proximal synapse learning system with something like the XCAL learning model.
 void Column::PerformBoosting()
 {
+	float activeDutyCycle = GetActiveDutyCycle();
+
 	// If this Column's ActiveDutyCycle is less than a small fraction of its MaxDutyCycle (the max ActiveDutyCycle 
 	// of the Columns within its InhibitionRadius), then increase its Boost.
-	if (ActiveDutyCycle < (maxDutyCycle * ActiveOverMaxDutyCycle_IncreaseBoostThreshold))
+	if (activeDutyCycle < (maxDutyCycle * ActiveOverMaxDutyCycle_IncreaseBoostThreshold))
 	{
 		// If this Column hasn't yet reached the specified MaxBoost...
 		if ((GetMaxBoost() == -1) || (Boost < GetMaxBoost()))
@@ -538,13 +961,23 @@ void Column::PerformBoosting()
 				// Set the permanence value of each of this Column's connected proximal synapses to exactly ConnectedPerm. This will make it easy
 				// for synapses from inactive inputs to become disconnected the next time this Column is activated, allowing this Column to come to 
 				// represent a smaller subpattern of what it currently represents.
-				FastListIter synapses_iter(ProximalSegment->Synapses);
-				for (Synapse *syn = (Synapse*)(synapses_iter.Reset()); syn != NULL; syn = (Synapse*)(synapses_iter.Advance()))
+				switch (region->ProximalSynapseParams.Format)
 				{
-					if (syn->GetPermanence() > region->ProximalSynapseParams.ConnectedPerm) {
-						syn->SetPermanence(region->ProximalSynapseParams.ConnectedPerm);
-					}
+				case PERMANENCE_FORMAT_16BIT:
+					LimitPermanenceValues(ProximalPermanences16, NumProximalSynapses, region->ProximalSynapseParams);
+					break;
+				case PERMANENCE_FORMAT_8BIT:
+					LimitPermanenceValues(ProximalPermanences8, NumProximalSynapses, region->ProximalSynapseParams);
+					break;
+				default:
+					LimitPermanenceValues(ProximalPermanences, NumProximalSynapses, region->ProximalSynapseParams);
+					break;
 				}
+
+				ProximalPermanencesChanged = true;
+
+				// Lowering permanences may have left fewer synapses well connected.
+				CountWellConnectedSynapses();
 			}
 
 			// Linearly increase Boost.
@@ -565,7 +998,7 @@ void Column::PerformBoosting()
 			BoostPermanences(region->GetBoostRate());
 		}
 	}
-	else if ((Boost > GetMinBoost()) && (ActiveDutyCycle > (maxDutyCycle * ActiveOverMaxDutyCycle_DecreaseBoostThreshold)) && (FastActiveDutyCycle > (maxDutyCycle * ActiveOverMaxDutyCycle_DecreaseBoostThreshold)))
+	else if ((Boost > GetMinBoost()) && (activeDutyCycle > (maxDutyCycle * ActiveOverMaxDutyCycle_DecreaseBoostThreshold)) && (GetFastActiveDutyCycle() > (maxDutyCycle * ActiveOverMaxDutyCycle_DecreaseBoostThreshold)))
 	{
 		// Linearly decrease Boost.
 		Boost = Max(Boost - region->GetBoostRate(), GetMinBoost());
@@ -577,70 +1010,25 @@ void Column::PerformBoosting()
 /// Returns: Maximum active duty cycle among neighboring columns.
 float Column::DetermineMaxDutyCycle()
 {
-	// The below code fails, not sure why. Commented out until I have time to investigate.
-	//// If this Column is not the upper-left COlumn in its hypercolumn, return the maxDutyCycle of that upper-left Column. 
-	//// All Columns within the same hypercolumns have the same inhbition area and so the same maxDutyCycle.
-	//if (((Position.X % region->GetHypercolumnDiameter()) != 0) || ((Position.Y % region->GetHypercolumnDiameter()) != 0)) {
-	//	return region->GetColumn(HypercolumnPosition.X * region->GetHypercolumnDiameter(), HypercolumnPosition.Y * region->GetHypercolumnDiameter())->GetMaxDutyCycle();
-	//}
-
-	// Find extents of neighboring columns within inhibitionRadius.
-	// InhibitionRadius is specified in hypercolumns.
-	Area inhibitionArea = DetermineColumnsWithinHypercolumnRadius(region->InhibitionRadius + 0.5f);
-
-	// Find the maxDutyCycle of all columns within inhibitionRadius
-	Column *col;
-	float maxDuty = 0.0f;
-	for (int x = inhibitionArea.MinX; x <= inhibitionArea.MaxX; x++)
-	{
-		for (int y = inhibitionArea.MinY; y <= inhibitionArea.MaxY; y++)
-		{
-			col = region->GetColumn(x, y);
-			if (col->GetActiveDutyCycle() > maxDuty)
-			{
-				maxDuty = col->GetActiveDutyCycle();
-			}
-		}
-	}
-
-	return maxDuty;
+	// All Columns within the same hypercolumn have the same inhibition area, and so the same maxDutyCycle.
+	// The maximum around every hypercolumn has already been found by the Region, once per time step.
+	return region->GetNeighborhoodMaxDutyCycle(HypercolumnPosition);
 }
 
-/// Computes a moving average of how often this column has been active 
-/// after inhibition.
-void Column::UpdateActiveDutyCycle()
+/// Moving average of how often this column has been active after inhibition, kept by the Region.
+float Column::GetActiveDutyCycle()
 {
-	float newCycle;
-
-	// Update ActiveDutyCycle
-	newCycle = (1.0f - EmaAlpha) * ActiveDutyCycle;
-	if (IsActive)
-	{
-		newCycle += EmaAlpha;
-	}
-	ActiveDutyCycle = newCycle;
-
-	// Update FastActiveDutyCycle
-	newCycle = (1.0f - FastEmaAlpha) * FastActiveDutyCycle;
-	if (IsActive)
-	{
-		newCycle += FastEmaAlpha;
-	}
-	FastActiveDutyCycle = newCycle;
+	return region->GetActiveDutyCycle(Index);
 }
 
-/// Computes a moving average of how often this column has overlap greater than
-/// MinOverlap.
-/// Exponential moving average (EMA):
-/// St = a * Yt + (1-a)*St-1
-void Column::UpdateOverlapDutyCycle()
+/// Faster moving average of how often this column has been active after inhibition, kept by the Region.
+float Column::GetFastActiveDutyCycle()
 {
-	float newCycle = (1.0f - EmaAlpha) * _overlapDutyCycle;
+	return region->GetFastActiveDutyCycle(Index);
+}
 
-	// CHANGED: Overlap is divided by Boost before being compared with _minOverlap, because _minOverlap doesn't have Boost factored into it. This makes them comparable.
-	if ((Overlap / Boost) >= _minOverlap) // Note: Numenta docs indicate >, but given its function in boosting of trying to raise overlap to a number that allows activation (ie., minOverlap), >= makes more sense to me. 
-	{
-		newCycle += EmaAlpha;
-	}
-	_overlapDutyCycle = newCycle;
+/// Moving average of how often this column's overlap has reached MinOverlap, kept by the Region.
+float Column::GetOverlapDutyCycle()
+{
+	return region->GetOverlapDutyCycle(Index);
 }
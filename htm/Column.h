@@ -3,17 +3,26 @@
 #include "Utils.h"
 #include "FastList.h"
 #include <list>
+#include <math.h>
 
 class Region;
 class Cell;
 class Column;
 class Segment;
 class Synapse;
+class ProximalSynapse;
+class BitArray;
 
 // Exponential Moving Average alpha value
 const float EmaAlpha = 0.005f;
 const float FastEmaAlpha = 0.008f;
 
+/// Returns the given exponential moving average, with the given alpha, after _steps time steps without activity.
+inline float DecayMovingAverage(float _value, float _alpha, int _steps)
+{
+	return (_steps == 1) ? (_value * (1.0f - _alpha)) : (_value * powf(1.0f - _alpha, (float)_steps));
+}
+
 // A Column's MinBoost and MaxBoost are up to this far from 1.0 and the given MaxBoost, respectively. 
 // This is to avoid ties in overlap values between columns with no boost, or with full boost.
 const float BoostVariance = 0.01f;
@@ -48,8 +57,11 @@ public:
 
 	Point Position, HypercolumnPosition;
 	Region *region;
-	float _overlapDutyCycle;
-	float ActiveDutyCycle, FastActiveDutyCycle, maxDutyCycle, MinBoost, MaxBoost, Boost;
+
+	// This Column's index within its Region's Columns. Its duty cycles are kept by the Region, at this index.
+	int Index;
+
+	float maxDutyCycle, MinBoost, MaxBoost, Boost;
 	bool IsActive, IsInhibited;
 	int prevBoostTime;
 
@@ -68,6 +80,56 @@ public:
 	// is such that multiple patterns cannot be supported on one synapse, so all but 1 will generally remain disconnected, so predictions are never made.
 	int MinOverlapToReuseSegment;
 
+	// The distinct distances of this Column's proximal synapses from its inputs, in increasing order,
+	// and the number of connected proximal synapses at each of those distances.
+	float *ReceptiveFieldDistances;
+	int *ConnectedCountAtDistance;
+	int NumReceptiveFieldDistances;
+
+	// Index into ReceptiveFieldDistances of the furthest connected proximal synapse, or -1 if none are connected.
+	int ReceptiveFieldDistanceIndex;
+
+	// The number of proximal synapses that are connected and active, and that are well connected (above
+	// InitialPermanence) and active, accumulated by the Region from the active input values each time step.
+	int ActiveConnectedSynapsesCount, ActiveWellConnectedSynapsesCount;
+
+	// The number of proximal synapses that are well connected (above InitialPermanence), kept up to
+	// date as permanences change.
+	int WellConnectedSynapsesCount;
+
+	// This Column's proximal synapses, with the state used by spatial pooling and learning stored in parallel
+	// arrays (in the order of ProximalSegment->Synapses) so that it can be streamed through. These permanences
+	// are authoritative; the ProximalSynapse objects' own permanences are only brought up to date by
+	// StoreProximalPermanences(), when needed for saving or display.
+	int NumProximalSynapses;
+	ProximalSynapse **ProximalSynapses;
+	unsigned char *ProximalConnected;
+	const BitArray **ProximalInputBits;
+	int *ProximalInputValues;
+
+	// Whether each proximal synapse's input was active, gathered at the start of AdaptPermanences().
+	unsigned char *ProximalInputActive;
+
+	// The permanences, stored in the format given by the Region's ProximalSynapseParams: as floats in
+	// ProximalPermanences, or as fixed point values in ProximalPermanences16 or ProximalPermanences8. 
+	// Only the array for that format is allocated; the others are NULL.
+	float *ProximalPermanences;
+	unsigned short *ProximalPermanences16;
+	unsigned char *ProximalPermanences8;
+
+	// Whether each proximal synapse is well connected (above InitialPermanence), kept up to date along with
+	// the permanences, so that overlap can be determined without reading them.
+	unsigned char *ProximalWellConnected;
+
+	// If the Region's SpatialLearningWindow is greater than 1, the number of learning steps within the current
+	// window during which each proximal synapse's input was active, and the number of learning steps this Column
+	// has had within the window. Otherwise ProximalActiveCounts is NULL.
+	unsigned short *ProximalActiveCounts;
+	int LearningStepCount;
+
+	// True if the permanences have changed since they were last stored in the ProximalSynapse objects.
+	bool ProximalPermanencesChanged;
+
 	//float _predictionCounter, _correctPredictionCounter;
 	//float _segmentPredictionCounter, _correctSegmentPredictionCounter;
 
@@ -79,11 +141,11 @@ public:
 	Region *GetRegion() {return region;}
 	void SetRegion(Region *value) {region = value;}
 
-	float GetActiveDutyCycle() {return ActiveDutyCycle;}
+	float GetActiveDutyCycle();
 
-	float GetFastActiveDutyCycle() {return FastActiveDutyCycle;}
+	float GetFastActiveDutyCycle();
 
-	float GetOverlapDutyCycle() {return _overlapDutyCycle;}
+	float GetOverlapDutyCycle();
 
 	float GetMaxDutyCycle() {return maxDutyCycle;}
 
@@ -91,6 +153,9 @@ public:
 
 	int GetMinOverlapToReuseSegment() {return MinOverlapToReuseSegment;}
 
+	/// The distance of this Column's furthest connected proximal synapse from its input.
+	float GetReceptiveFieldSize() {return (ReceptiveFieldDistanceIndex == -1) ? 0.0f : ReceptiveFieldDistances[ReceptiveFieldDistanceIndex];}
+
 	/// A proximal dendrite segment forms synapses with feed-forward inputs.
 	Segment *ProximalSegment;
 
@@ -183,7 +248,8 @@ public:
 	/// The spatial pooler overlap of this column with a particular input pattern.
 	/// The overlap for each column is simply the number of connected synapses with active 
 	/// inputs, multiplied by its boost. If this value is below MinOverlap, we set the 
-	/// overlap score to zero.
+	/// overlap score to zero. The Region must first have accumulated this column's active 
+	/// synapse counts, with Region::AccumulateProximalActivity().
 	/// Attention: refactored regarding MinOverlap from column: overlap is now computed as 
 	/// the former overlap per area as this will make areas with inequal size comparable
 	void ComputeOverlap();
@@ -197,17 +263,55 @@ public:
 	/// Determine whether this Column will be active or inhibited.
 	void ComputeColumnInhibition();
 
+	/// Returns true if this Column's overlap, without its Boost, is at least its MinOverlap.
+	bool HasMinOverlap();
+
 	/// Update the permanence value of every synapse in this column based on whether active.
 	/// This is the main learning rule (for the column's proximal dentrite). 
 	/// For winning columns, if a synapse is active, its permanence value is incremented, 
 	/// otherwise it is decremented. Permanence values are constrained to be between 0 and 1.
 	void AdaptPermanences();
 
+	/// Record which of this Column's proximal synapses are active, for the learning step that will be applied
+	/// to their permanences by ApplyAccumulatedLearning() at the end of the SpatialLearningWindow.
+	void AccumulateLearning();
+
+	/// Apply to the permanences the net result of the learning steps accumulated since this was last called,
+	/// as AdaptPermanences() would have over those steps (apart from being kept within [0, 1] only once).
+	void ApplyAccumulatedLearning();
+
 	/// Increase the permanence value of every unconnected synapse in this column by a scale factor.
 	void BoostPermanences(float scale);
 
-	// Update running averages of activty and overlap.
-	void UpdateDutyCycles();
+	/// Rebuild the arrays of proximal synapse state from the ProximalSegment's synapses. Called after
+	/// the proximal synapses have been created or loaded.
+	void InitializeProximalSynapses();
+
+	/// Copy the permanences of the proximal synapses into the ProximalSynapse objects, if they have
+	/// changed since last stored.
+	void StoreProximalPermanences();
+
+	/// Returns the permanence of the proximal synapse with the given index, whatever format it is stored in.
+	float GetProximalPermanence(int _index);
+
+	/// Set the permanence of the proximal synapse with the given index, in the format it is stored in. Its
+	/// ProximalConnected and ProximalWellConnected values are not updated.
+	void SetProximalPermanence(int _index, float _permanence);
+
+	/// Rebuild the record of how many connected proximal synapses this Column has at each distance
+	/// from its inputs. Called after InitializeProximalSynapses().
+	void InitializeReceptiveField();
+
+	/// Count the proximal synapses with permanence above InitialPermanence, and record which they are.
+	void CountWellConnectedSynapses();
+
+	/// Update ProximalConnected for any proximal synapses whose permanences have crossed ConnectedPerm,
+	/// and the record of connected proximal synapses along with them.
+	void UpdateProximalConnections();
+
+	/// Update the record of connected proximal synapses after the synapse with the given index has become
+	/// connected or disconnected.
+	void ProximalSynapseConnectionChanged(int _synapseIndex);
 
 	/// There are two separate boosting mechanisms in place to help a column learn connections. 
 	/// If a column does not win often enough (as measured by activeDutyCycle), its overall 
@@ -221,14 +325,4 @@ public:
 	/// inhibitionRadius of this column.
 	/// Returns: Maximum active duty cycle among neighboring columns.
 	float DetermineMaxDutyCycle();
-
-	/// Computes a moving average of how often this column has been active 
-	/// after inhibition.
-	void UpdateActiveDutyCycle();
-
-	/// Computes a moving average of how often this column has overlap greater than
-	/// MinOverlap.
-	/// Exponential moving average (EMA):
-	/// St = a * Yt + (1-a)*St-1
-	void UpdateOverlapDutyCycle();
 };
\ No newline at end of file
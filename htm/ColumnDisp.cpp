@@ -4,6 +4,7 @@
 #include "Cell.h"
 #include "View.h"
 #include "Synapse.h"
+#include "ActivitySnapshot.h"
 #include <QtGui/QBrush>
 #include <QtGui/QPainter>
 #include <QtWidgets/QStyleOptionGraphicsItem>
@@ -114,7 +115,10 @@ void ColumnDisp::paint(QPainter *painter, const QStyleOptionGraphicsItem *option
 		// Loop through all cells in this column...
 		bool active = false, predicted = false, predicted_1step = false, learning = false;
 		int x = 0, y = 0;
-		Cell *cell;
+
+		// The cells' state is read from the displayed snapshot rather than the network, which may be running.
+		DataSpaceSnapshot *snapshot = view->GetSnapshot();
+
 		for (int i = 0; i < numItems; i++)
 		{
 			// If this cell is selected, first draw thicker black outline.
@@ -131,19 +135,19 @@ void ColumnDisp::paint(QPainter *painter, const QStyleOptionGraphicsItem *option
 				painter->setPen(QPen(QBrush(QColor(255,0,0)), 0.08));
 			}
 
-			if (view->GetViewActivity())
+			if (view->GetViewActivity() && (snapshot != NULL))
 			{
 				// Determine whether the current cell is active.
-				active = (region == NULL) ? dataSpace->GetIsActive(colX, colY, i) : region->IsCellActive(colX, colY, i);
+				active = snapshot->GetIsActive(colX, colY, i);
 
 				// If not active, determine whether the current cell is predicted to be active in the future.
 				if (!active) 
 				{
-					predicted = (region == NULL) ? false : region->IsCellPredicted(colX, colY, i);
-					predicted_1step = (predicted == false) ? false : (region->GetCell(colX, colY, i)->GetNumPredictionSteps() == 1);
+					predicted = snapshot->GetIsPredicted(colX, colY, i);
+					predicted_1step = (predicted == false) ? false : (snapshot->GetNumPredictionSteps(colX, colY, i) == 1);
 				}
 
-				learning = (region == NULL) ? false : region->IsCellLearning(colX, colY, i);
+				learning = snapshot->GetIsLearning(colX, colY, i);
 
 				// Set the brush to the color of this cell, depending on whether it is inactive, active, or predicted, or displaying a synapse permanence.
 				painter->setBrush(active ? colorActive : (predicted ? (predicted_1step ? colorPredicted1Step : colorPredicted) : colorInactive));
@@ -170,11 +174,8 @@ void ColumnDisp::paint(QPainter *painter, const QStyleOptionGraphicsItem *option
 			}
 
 			// If appropriate, display predicted time number (and learning state) on this cell.
-			if (view->GetViewActivity() && (lod >= 50) && (predicted || learning))
+			if (view->GetViewActivity() && (snapshot != NULL) && (lod >= 50) && (predicted || learning))
 			{
-				cell = column->GetCellByIndex(i);
-				_ASSERT(cell != NULL);
-
 				QString str;
 
 				if (learning) 
@@ -185,7 +186,7 @@ void ColumnDisp::paint(QPainter *painter, const QStyleOptionGraphicsItem *option
 				else 
 				{
 					painter->setPen(QPen(QBrush(colorActive), 0.1));
-					str.setNum(cell->GetNumPredictionSteps());
+					str.setNum(snapshot->GetNumPredictionSteps(colX, colY, i));
 				}
 
 				float scale = 50.0f * numRows;
@@ -318,10 +319,11 @@ void ColumnDisp::SetSelection(bool _colSelected, int _selCellIndex)
 	update();
 }
 
-void ColumnDisp::SelectSynapse(Synapse *_synapse, int _cellIndex)
+void ColumnDisp::SelectSynapse(int _cellIndex, float _permanence, float _connectedPerm)
 {
-	if ((sel_synapses[_cellIndex].synapse == NULL) || (sel_synapses[_cellIndex].permanence < _synapse->GetPermanence())) {
-		sel_synapses[_cellIndex] = SynapseRecord(_synapse, _cellIndex, _synapse->GetPermanence(), _synapse->Params->ConnectedPerm);
+	std::map<int,SynapseRecord>::iterator iter = sel_synapses.find(_cellIndex);
+	if ((iter == sel_synapses.end()) || (iter->second.permanence < _permanence)) {
+		sel_synapses[_cellIndex] = SynapseRecord(_cellIndex, _permanence, _connectedPerm);
 	}
 
 	// Redraw ths ColumnDisp.
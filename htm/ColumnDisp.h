@@ -10,7 +10,6 @@ class QStyleOptionGraphicsItem;
 class Region;
 class Column;
 class View;
-class Synapse;
 class SynapseRecord;
 
 class ColumnDisp : public QGraphicsItem
@@ -26,7 +25,7 @@ public:
 
 		void SetSelection(bool _colSelected, int _selCellIndex);
 
-		void SelectSynapse(Synapse *_synapse, int _cellIndex);
+		void SelectSynapse(int _cellIndex, float _permanence, float _connectedPerm);
 		void ClearSelectedSynapses();
 
 protected:
@@ -55,10 +54,9 @@ private:
 class SynapseRecord
 {
 public:
-	SynapseRecord() {synapse = NULL; cellIndex = -1; permanence = 0; connectedPerm = 0;}
-	SynapseRecord(Synapse *_synapse, int _cellIndex, float _permanence, float _connectedPerm) {synapse = _synapse; cellIndex = _cellIndex; permanence = _permanence; connectedPerm = _connectedPerm;}
+	SynapseRecord() {cellIndex = -1; permanence = 0; connectedPerm = 0;}
+	SynapseRecord(int _cellIndex, float _permanence, float _connectedPerm) {cellIndex = _cellIndex; permanence = _permanence; connectedPerm = _connectedPerm;}
 
-	Synapse *synapse;
 	int cellIndex;
 	float permanence, connectedPerm;
 };
@@ -1,5 +1,6 @@
 #pragma once
-#include <QtCore/qstring.h>
+#include <string>
+#include "BitArray.h"
 
 typedef int DataSpaceType;
 const DataSpaceType DATASPACE_TYPE_INPUTSPACE = 0;
@@ -10,10 +11,10 @@ class DataSpace
 {
 public:
 
-	DataSpace(QString &_id) {id = _id; index = -1;}
+	DataSpace(const std::string &_id) {id = _id; index = -1;}
 
-	const QString &GetID() {return id;}
-	void SetID(QString &_id) {id = _id;}
+	const std::string &GetID() {return id;}
+	void SetID(const std::string &_id) {id = _id;}
 
 	void SetIndex(int _index) {index = _index;}
 	int GetIndex() {return index;}
@@ -28,7 +29,39 @@ public:
 
 	virtual bool GetIsActive(int _x, int _y, int _index)=0;
 
-	QString id;
+	// Returns the index of the given value within the DataSpace, counting values of each position
+	// together, in rows.
+	int GetValueIndex(int _x, int _y, int _index) {return (((_y * GetSizeX()) + _x) * GetNumValues()) + _index;}
+
+	// Returns the activity of all of this DataSpace's values, packed into bits in the order of their
+	// indices (see GetValueIndex()). The bits remain valid until this DataSpace's activity next changes.
+	virtual const BitArray &DetermineActiveBits()
+	{
+		int valueIndex = 0;
+
+		activeBits.Resize(GetSizeX() * GetSizeY() * GetNumValues());
+
+		for (int y = 0; y < GetSizeY(); y++) {
+			for (int x = 0; x < GetSizeX(); x++) {
+				for (int i = 0; i < GetNumValues(); i++, valueIndex++) {
+					if (GetIsActive(x, y, i)) {
+						activeBits.Set(valueIndex, true);
+					}
+				}
+			}
+		}
+
+		return activeBits;
+	}
+
+	// Returns the activity of this DataSpace's values as of the last call to DetermineActiveBits(). The
+	// BitArray itself remains in place for the life of the DataSpace, so it may be referred to directly.
+	const BitArray &GetActiveBits() {return activeBits;}
+
+	std::string id;
 	int index;
-};
 
+protected:
+
+	BitArray activeBits;
+};
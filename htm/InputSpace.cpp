@@ -1,10 +1,11 @@
 #include "InputSpace.h"
 #include "Utils.h"
 #include <string.h>
+#include <stdlib.h>
 #include <crtdbg.h>
 
-InputSpace::InputSpace(QString &_id, int _sizeX, int _sizeY, int _numValues, std::vector<PatternInfo*> &_patterns)
-	: DataSpace(_id), image(NULL), patterns(_patterns)
+InputSpace::InputSpace(const std::string &_id, int _sizeX, int _sizeY, int _numValues, std::vector<PatternInfo*> &_patterns)
+	: DataSpace(_id), patterns(_patterns)
 {
 	sizeX = _sizeX;
 	sizeY = _sizeY;
@@ -12,8 +13,8 @@ InputSpace::InputSpace(QString &_id, int _sizeX, int _sizeY, int _numValues, std
 
 	rowSize = sizeX * numValues;
 
-	// Create data array.
-	data = new int[_sizeX * _sizeY * _numValues];
+	// Create the array of bits representing each value's activity.
+	activeBits.Resize(_sizeX * _sizeY * _numValues);
 
 	// Create image processing buffer.
 	buffer = new int[_sizeX * _sizeY];
@@ -24,9 +25,6 @@ InputSpace::InputSpace(QString &_id, int _sizeX, int _sizeY, int _numValues, std
 
 InputSpace::~InputSpace(void)
 {
-	// Delete data array.
-	delete [] data;
-
 	// Delete image processing buffer.
 	delete [] buffer;
 
@@ -66,7 +64,7 @@ bool InputSpace::GetIsActive(int _x, int _y, int _index)
 	_ASSERT((_y >= 0) && (_y < sizeY));
 	_ASSERT((_index >= 0) && (_index < numValues));
 
-	return (data[(_y * rowSize) + (_x * numValues) + _index] != 0);
+	return activeBits.Get((_y * rowSize) + (_x * numValues) + _index);
 }
 
 void InputSpace::SetIsActive(int _x, int _y, int _index, bool _active)
@@ -75,13 +73,13 @@ void InputSpace::SetIsActive(int _x, int _y, int _index, bool _active)
 	_ASSERT((_y >= 0) && (_y < sizeY));
 	_ASSERT((_index >= 0) && (_index < numValues));
 
-	data[(_y * rowSize) + (_x * numValues) + _index] = (_active ? 1 : 0);
+	activeBits.Set((_y * rowSize) + (_x * numValues) + _index, _active);
 }
 
 void InputSpace::DeactivateAll()
 {
-	// Reset all values in data array to 0.
-	memset(data, 0, sizeY * rowSize * sizeof(int));
+	// Reset all values to 0.
+	activeBits.ClearAll();
 }
 
 void InputSpace::ApplyPatterns(int _time)
@@ -121,7 +119,6 @@ void InputSpace::ApplyPattern(PatternInfo *_pattern, int _time)
 	}
 
 	int x, y, x1, y1, i, numSteps, step;
-	float scale;
 	int* bitmap;
 	ImageInfo *imageInfo;
 	
@@ -236,50 +233,9 @@ void InputSpace::ApplyPattern(PatternInfo *_pattern, int _time)
 		break;
 
 	case PATTERN_TEXT:
-		// Apply text test pattern.
-
-		// If this isn't the start of a new trial, no need to update activity.
-		if (_time != _pattern->curTrialStartTime) {
-			break;
-		}
-
-		// Start by clearing all activity.
-		DeactivateAll();
-
-		numSteps = _pattern->string.length();
-		step = (numSteps > 0) ? ((_pattern->trialCount - 1) % numSteps) : 0;
-		scale = 0.8 * ((float)sizeY / 8.0f);
-
-		// Initialize image and painter if not yet done.
-		if (image == NULL) 
-		{
-			image = new QImage(sizeX, sizeY, QImage::Format_Mono);
-			painter = new QPainter(image);
-			painter->setPen(QColor(255,255,255));
-			painter->setFont(QFont("Times", 10, QFont::Bold));
-			painter->scale(scale, scale);
-		}
-
-		// Draw the text to the image.
-		image->fill(0);
-		painter->drawText(QRect(0, 0, (float)sizeX / scale, (float)sizeY / scale), Qt::AlignCenter, _pattern->string.mid(step, 1)); 
-
-		for (y = 0; y < sizeY; y++)
-		{
-			for (x = 0; x < sizeX; x++)
-			{
-				if (QColor(image->pixel(x,y)).lightness() >= 128) 
-				{
-					for (i = 0; i < numValues; i++) {
-						SetIsActive(x, y, i, true);
-					}
-				}				
-			}
-		}
-		break;
-
 	case PATTERN_BITMAP:
-		// Apply bitmap test pattern.
+		// Apply bitmap test pattern. Text patterns are rendered into one bitmap per character when 
+		// the network is loaded, so they are applied in the same way.
 
 		// If this isn't the start of a new trial, no need to update activity.
 		if (_time != _pattern->curTrialStartTime) {
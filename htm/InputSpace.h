@@ -1,7 +1,7 @@
 #pragma once
 #include "DataSpace.h"
-#include <QtGui/QImage>
-#include <QtGui/QPainter>
+#include <string>
+#include <vector>
 
 enum PatternType
 {
@@ -31,7 +31,7 @@ enum PatternImageMotion
 class ImageInfo
 {
 public:
-	QString label;
+	std::string label;
 	int width, height, contentX, contentY, contentWidth, contentHeight;
 	float *data;
 };
@@ -40,7 +40,7 @@ class PatternInfo
 {
 public:
 	PatternInfo() : type(PATTERN_NONE), startTime(-1), endTime(-1), minTrialDuration(1), maxTrialDuration(1), string(""), imageMotion(PATTERN_IMAGE_MOTION_NONE), trialCount(0), curTrialStartTime(-1), nextTrialStartTime(-1) {};
-	PatternInfo(PatternType _type, int _startTime, int _endTime, int _minTrialDuration, int _maxTrialDuration, QString &_string, PatternImageMotion _imageMotion, std::vector<int*> &_bitmaps, std::vector<ImageInfo*> &_images) : type(_type), startTime(_startTime), endTime(_endTime), minTrialDuration(_minTrialDuration), maxTrialDuration(_maxTrialDuration), string(_string), imageMotion(_imageMotion), trialCount(0), curTrialStartTime(-1), nextTrialStartTime(-1), bitmaps(_bitmaps), images(_images) {};
+	PatternInfo(PatternType _type, int _startTime, int _endTime, int _minTrialDuration, int _maxTrialDuration, const std::string &_string, PatternImageMotion _imageMotion, std::vector<int*> &_bitmaps, std::vector<ImageInfo*> &_images) : type(_type), startTime(_startTime), endTime(_endTime), minTrialDuration(_minTrialDuration), maxTrialDuration(_maxTrialDuration), string(_string), imageMotion(_imageMotion), trialCount(0), curTrialStartTime(-1), nextTrialStartTime(-1), bitmaps(_bitmaps), images(_images) {};
 	PatternInfo(PatternInfo &_original) {type = _original.type; startTime = _original.startTime, endTime = _original.endTime; minTrialDuration = _original.minTrialDuration; maxTrialDuration = _original.maxTrialDuration; string = _original.string; imageMotion = _original.imageMotion; trialCount = 0; curTrialStartTime = -1; nextTrialStartTime = -1;}
 
 	PatternType type;
@@ -49,7 +49,10 @@ public:
 	int startTime, endTime;
 	int minTrialDuration, maxTrialDuration;
 	int startX, startY, endX, endY;
-	QString string;
+	std::string string;
+
+	// For PATTERN_BITMAP, the given bitmaps. For PATTERN_TEXT, one bitmap per character of the string, 
+	// rendered when the network is loaded.
 	std::vector<int*> bitmaps;
 	std::vector<ImageInfo*> images;
 	int *buffer;
@@ -61,20 +64,17 @@ class InputSpace
 	: public DataSpace
 {
 public:
-	InputSpace(QString &_id, int _sizeX, int _sizeY, int _numValues, std::vector<PatternInfo*> &_patterns);
+	InputSpace(const std::string &_id, int _sizeX, int _sizeY, int _numValues, std::vector<PatternInfo*> &_patterns);
 	~InputSpace(void);
 
 	// Properties
 
 	int sizeX, sizeY, numValues, testPatterns;
 	int rowSize;
-	int *data, *buffer;
+	int *buffer;
 
 	std::vector<PatternInfo*> patterns;
 
-	QImage *image;
-	QPainter *painter;
-
 	// Methods
 
 	DataSpaceType GetDataSpaceType() {return DATASPACE_TYPE_INPUTSPACE;}
@@ -85,6 +85,7 @@ public:
 	int GetHypercolumnDiameter();
 
 	bool GetIsActive(int _x, int _y, int _index);
+	const BitArray &DetermineActiveBits() {return activeBits;}
 	void SetIsActive(int _x, int _y, int _index, bool _active);
 	void DeactivateAll();
 
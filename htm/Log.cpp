@@ -0,0 +1,22 @@
+#include <stdio.h>
+#include "Log.h"
+
+const char *LOG_FILENAME = "log.txt";
+
+/// Append the given line of text to the log file (log.txt).
+void WriteToLog(const std::string &_text)
+{
+	FILE *file = fopen(LOG_FILENAME, "a");
+
+	if (file != NULL)
+	{
+		fprintf(file, "%s\n", _text.c_str());
+		fclose(file);
+	}
+}
+
+/// Delete the log file, if it exists.
+void ClearLog()
+{
+	remove(LOG_FILENAME);
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include <string>
+
+const int LOG_BUFFER_LEN = 1000;
+
+/// Append the given line of text to the log file (log.txt).
+void WriteToLog(const std::string &_text);
+
+/// Delete the log file, if it exists.
+void ClearLog();
@@ -5,7 +5,6 @@
 #include "FastHash.h"
 #include "FastList.h"
 #include "ProximalSynapse.h"
-#include "DistalSynapse.h"
 #include "Segment.h"
 #include "SegmentUpdateInfo.h"
 #include "Cell.h"
@@ -145,9 +144,6 @@ void MemManager::ReleaseAll(MemObjectType _object_type)
       break;
 		case MOT_PROXIMAL_SYNAPSE:
 			delete [] (ProximalSynapse*)(cur_node->chunk);
-      break;
-		case MOT_DISTAL_SYNAPSE:
-			delete [] (DistalSynapse*)(cur_node->chunk);
       break;
 		case MOT_SEGMENT:
 			delete [] (Segment*)(cur_node->chunk);
@@ -276,19 +272,6 @@ void MemManager::NewChunk(MemObjectType _object_type)
 		freeCountArray[_object_type] += PROXIMAL_SYNAPSE_CHUNK_LENGTH;
 		countArray[_object_type] += PROXIMAL_SYNAPSE_CHUNK_LENGTH;
 		break;
-  case MOT_DISTAL_SYNAPSE:
-		// Create the new chunk
-		new_node->chunk = new DistalSynapse[DISTAL_SYNAPSE_CHUNK_LENGTH];
-
-		// Add all of the new chunk's objects to the free list
-		for (int i = 0; i < DISTAL_SYNAPSE_CHUNK_LENGTH; i++)
-		{
-			((DistalSynapse*)(new_node->chunk))[i].mem_next = freeListArray[_object_type];
-			freeListArray[_object_type] = &(((DistalSynapse*)(new_node->chunk))[i]);
-		}
-		freeCountArray[_object_type] += DISTAL_SYNAPSE_CHUNK_LENGTH;
-		countArray[_object_type] += DISTAL_SYNAPSE_CHUNK_LENGTH;
-		break;
 	case MOT_SEGMENT:
 		// Create the new chunk
 		new_node->chunk = new Segment[SEGMENT_CHUNK_LENGTH];
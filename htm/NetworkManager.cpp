@@ -2,11 +2,15 @@
 #include "NetworkManager.h"
 #include "Synapse.h"
 #include "Cell.h"
+#include "Log.h"
 #include <cstring>
+#include <climits>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QDir>
 #include <QtCore/QTextStream>
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
 
 extern MemManager mem_manager;
 
@@ -17,7 +21,7 @@ NetworkManager::NetworkManager(void)
 	networkLoaded = false;
 
 	// Delete log file if it exists.
-	QFile::remove("log.txt");
+	ClearLog();
 }
 
 NetworkManager::~NetworkManager(void)
@@ -50,6 +54,9 @@ void NetworkManager::ClearNetwork()
 		delete region;
 	}
 
+	// Clear the map of DataSpace IDs.
+	dataSpaceMap.clear();
+
 	// Initialize members.
 	filename = "";
 	time = 0;
@@ -130,6 +137,14 @@ bool NetworkManager::LoadNetwork(QString &_filename, QXmlStreamReader &_xml, QSt
 
 				// Add the new Region to the list of Regions.
 				regions.push_back(newRegion);
+
+				// Add the new Region to the map of DataSpace IDs. Each Region and InputSpace must have a unique ID.
+				if (!(dataSpaceMap.insert(std::make_pair(newRegion->GetID(), (DataSpace*)newRegion)).second))
+				{
+					_error_msg = "Duplicate DataSpace id " + QString::fromStdString(newRegion->GetID()) + ".";
+					ClearNetwork();
+					return false;
+				}
 			}
 
 			// If this is a InputSpace element, read in the InputSpace's information.
@@ -149,6 +164,14 @@ bool NetworkManager::LoadNetwork(QString &_filename, QXmlStreamReader &_xml, QSt
 
 				// Add the new InputSpace to the list of InputSpaces.
 				inputSpaces.push_back(newInputSpace);
+
+				// Add the new InputSpace to the map of DataSpace IDs. Each Region and InputSpace must have a unique ID.
+				if (!(dataSpaceMap.insert(std::make_pair(newInputSpace->GetID(), (DataSpace*)newInputSpace)).second))
+				{
+					_error_msg = "Duplicate DataSpace id " + QString::fromStdString(newInputSpace->GetID()) + ".";
+					ClearNetwork();
+					return false;
+				}
 			}
 
 			// If this is a Classifier element, read in the Classifier's information.
@@ -200,14 +223,14 @@ bool NetworkManager::LoadNetwork(QString &_filename, QXmlStreamReader &_xml, QSt
 	DataSpace *dataSpace;
 	for (std::vector<Region*>::const_iterator region_iter = regions.begin(), end = regions.end(); region_iter != end; ++region_iter) 
 	{
-		for (std::vector<QString>::const_iterator input_id_iter = (*region_iter)->InputIDs.begin(), end = (*region_iter)->InputIDs.end(); input_id_iter != end; ++input_id_iter) 
+		for (std::vector<std::string>::const_iterator input_id_iter = (*region_iter)->InputIDs.begin(), end = (*region_iter)->InputIDs.end(); input_id_iter != end; ++input_id_iter) 
 		{
 			// Get a pointer to the DataSpace with this Region's current input's ID.
 			dataSpace = GetDataSpace(*input_id_iter);
 
 			if (dataSpace == NULL)
 			{
-				_error_msg = "Region " + (*region_iter)->id + "'s input " + *input_id_iter + " is not a known Region or InputSpace.";
+				_error_msg = "Region " + QString::fromStdString((*region_iter)->id) + "'s input " + QString::fromStdString(*input_id_iter) + " is not a known Region or InputSpace.";
 				ClearNetwork();
 				return false;
 			}
@@ -231,7 +254,7 @@ bool NetworkManager::LoadNetwork(QString &_filename, QXmlStreamReader &_xml, QSt
 
 		if (((*classifier_iter)->inputspace == NULL) || ((*classifier_iter)->region == NULL))
 		{
-			_error_msg = "Classifier " + (*classifier_iter)->id + " must have both a valid region and inputspace.";
+			_error_msg = "Classifier " + QString::fromStdString((*classifier_iter)->id) + " must have both a valid region and inputspace.";
 			return false;
 		}
 	}
@@ -352,11 +375,17 @@ Region *NetworkManager::ParseRegion(QXmlStreamReader &_xml, SynapseParameters _p
 	bool hardcodedSpatial = false, outputColumnActivity = false, outputCellActivity = true; 
 	float percentageInputPerCol = 0.0f, percentageMinOverlap = 0.0f, percentageLocalActivity = 0.0f, maxBoost = -1, boostRate = 0.01f;
 	int predictionRadius = -1, segmentActivateThreshold = 0, newNumberSynapses = 0;
+	int numThreads = 1;
+	bool lazyDutyCycles = false;
+	PermanenceFormat permanenceFormat = PERMANENCE_FORMAT_FLOAT;
+	int spatialLearningWindow = 1;
 	InhibitionTypeEnum inhibitionType = INHIBITION_TYPE_AUTOMATIC;
 	int inhibitionRadius = -1;
 	Region *newRegion = NULL;
-	std::vector<QString> input_ids;
+	std::vector<std::string> input_ids;
 	std::vector<int> input_radii;
+	std::vector<std::string> statistic_ids;
+	std::vector<int> statistic_sampleIntervals, statistic_columnIntervals, statistic_reportIntervals;
 	bool inputFound = false, result;
 	QString temp_string;
 
@@ -492,6 +521,59 @@ Region *NetworkManager::ParseRegion(QXmlStreamReader &_xml, SynapseParameters _p
 				}
 			}
 
+			// Threads
+			else if (tokenName == "threads") 
+			{
+				_xml.readNext();
+				if(_xml.tokenType() == QXmlStreamReader::Characters) {
+					numThreads = _xml.text().toString().toInt();
+				}
+			}
+
+			// LazyDutyCycles
+			else if (tokenName == "lazydutycycles") 
+			{
+				_xml.readNext();
+				if(_xml.tokenType() == QXmlStreamReader::Characters) {
+					lazyDutyCycles = (_xml.text().toString().toLower() == "true");
+				}
+			}
+
+			// SpatialLearningWindow
+			else if (tokenName == "spatiallearningwindow") 
+			{
+				_xml.readNext();
+				if(_xml.tokenType() == QXmlStreamReader::Characters) {
+					spatialLearningWindow = _xml.text().toString().toInt();
+				}
+			}
+
+			// PermanenceFormat
+			else if (tokenName == "permanenceformat") 
+			{
+				_xml.readNext();
+				if(_xml.tokenType() == QXmlStreamReader::Characters) 
+				{
+					if (_xml.text().toString().toLower() == "float") 
+					{
+						permanenceFormat = PERMANENCE_FORMAT_FLOAT;
+					} 
+					else if (_xml.text().toString().toLower() == "16bit") 
+					{
+						permanenceFormat = PERMANENCE_FORMAT_16BIT;
+					} 
+					else if (_xml.text().toString().toLower() == "8bit") 
+					{
+						permanenceFormat = PERMANENCE_FORMAT_8BIT;
+					} 
+					else 
+					{
+						_error_msg = "Region " + id + " has unknown PermanenceFormat " + _xml.text().toString() + ".";
+						return NULL;
+					}
+				}
+			}
+
 			// PercentageInputPerCol
 			else if (tokenName == "percentageinputpercol") 
 			{
@@ -631,7 +713,7 @@ Region *NetworkManager::ParseRegion(QXmlStreamReader &_xml, SynapseParameters _p
 
 				if (attributes.hasAttribute("id")) 
 				{
-					input_ids.push_back(attributes.value("id").toString());
+					input_ids.push_back(attributes.value("id").toString().toStdString());
 					inputFound = true;
 				}
 
@@ -651,6 +733,30 @@ Region *NetworkManager::ParseRegion(QXmlStreamReader &_xml, SynapseParameters _p
 				// Record inputRadius for this input DataSpace.
 				input_radii.push_back(inputRadius);
 			}
+
+			// Statistic
+			else if (tokenName == "statistic") 
+			{
+				attributes = _xml.attributes();
+
+				if (attributes.hasAttribute("id") == false)
+				{
+					_error_msg = "Region " + id + " has a Statistic with no id.";
+					return NULL;
+				}
+
+				// Record the settings given for the Statistic, to be applied once the Region exists. -1 means unchanged.
+				statistic_ids.push_back(attributes.value("id").toString().toStdString());
+				statistic_sampleIntervals.push_back(attributes.hasAttribute("sample") ? attributes.value("sample").toString().toInt() : -1);
+				statistic_columnIntervals.push_back(attributes.hasAttribute("columns") ? attributes.value("columns").toString().toInt() : -1);
+				statistic_reportIntervals.push_back(attributes.hasAttribute("report") ? attributes.value("report").toString().toInt() : -1);
+
+				if ((statistic_sampleIntervals.back() < -1) || ((statistic_columnIntervals.back() != -1) && (statistic_columnIntervals.back() < 1)) || ((statistic_reportIntervals.back() != -1) && (statistic_reportIntervals.back() < 1)))
+				{
+					_error_msg = "Region " + id + " has invalid intervals for Statistic " + attributes.value("id").toString() + ".";
+					return NULL;
+				}
+			}
 		}
 		
 		// Advance to next token...
@@ -785,6 +891,19 @@ Region *NetworkManager::ParseRegion(QXmlStreamReader &_xml, SynapseParameters _p
 		return NULL;
 	}
 
+	if (numThreads < 1)
+	{
+		_error_msg = "Region " + id + " has invalid Threads " + QString::number(numThreads) + ".";
+		return NULL;
+	}
+
+	// The counts of active inputs accumulated over a window are 16 bit.
+	if ((spatialLearningWindow < 1) || (spatialLearningWindow > USHRT_MAX))
+	{
+		_error_msg = "Region " + id + " has invalid SpatialLearningWindow " + QString::number(spatialLearningWindow) + ".";
+		return NULL;
+	}
+
 	if ((outputColumnActivity == false) && (outputCellActivity == false))
 	{
 		_error_msg = "Region " + id + " has no output.";
@@ -819,12 +938,49 @@ Region *NetworkManager::ParseRegion(QXmlStreamReader &_xml, SynapseParameters _p
 	}
 
 	// Create the new Region.
-	newRegion = new Region(this, id, Point(sizeX, sizeY), hypercolumnDiameter, _proximalSynapseParams, _distalSynapseParams, percentageInputPerCol / 100.0f, percentageMinOverlap / 100.0f, predictionRadius, inhibitionType, inhibitionRadius, percentageLocalActivity / 100.0f, boostRate, maxBoost, spatialLearningStartTime, spatialLearningEndTime, temporalLearningStartTime, temporalLearningEndTime, boostingStartTime, boostingEndTime, cellsPerColumn, segmentActivateThreshold, newNumberSynapses, min_MinOverlapToReuseSegment, max_MinOverlapToReuseSegment, hardcodedSpatial, outputColumnActivity, outputCellActivity);
+	newRegion = new Region(this, id.toStdString(), Point(sizeX, sizeY), hypercolumnDiameter, _proximalSynapseParams, _distalSynapseParams, percentageInputPerCol / 100.0f, percentageMinOverlap / 100.0f, predictionRadius, inhibitionType, inhibitionRadius, percentageLocalActivity / 100.0f, boostRate, maxBoost, spatialLearningStartTime, spatialLearningEndTime, temporalLearningStartTime, temporalLearningEndTime, boostingStartTime, boostingEndTime, cellsPerColumn, segmentActivateThreshold, newNumberSynapses, min_MinOverlapToReuseSegment, max_MinOverlapToReuseSegment, hardcodedSpatial, outputColumnActivity, outputCellActivity);
 
 	// Record in the new Region its lists of input IDs and radii.
 	newRegion->InputIDs = input_ids;
 	newRegion->InputRadii = input_radii;
 
+	// Set the number of threads that will perform the new Region's spatial pooling.
+	newRegion->SetNumThreads(numThreads);
+
+	// Set whether the new Region's duty cycles are updated lazily.
+	newRegion->SetLazyDutyCycles(lazyDutyCycles);
+
+	// Set the format in which the new Region's synapse permanences are stored.
+	newRegion->SetPermanenceFormat(permanenceFormat);
+
+	// Set the number of time steps over which the new Region's spatial learning is accumulated.
+	newRegion->SetSpatialLearningWindow(spatialLearningWindow);
+
+	// Apply the settings given for the new Region's Statistics. A sample interval of 0 disables a Statistic.
+	for (int statisticIndex = 0; statisticIndex < (int)statistic_ids.size(); statisticIndex++)
+	{
+		Statistic *statistic = newRegion->GetStatistic(statistic_ids[statisticIndex]);
+
+		if (statistic == NULL)
+		{
+			_error_msg = "Region " + id + " has unknown Statistic " + QString::fromStdString(statistic_ids[statisticIndex]) + ".";
+			delete newRegion;
+			return NULL;
+		}
+
+		if (statistic_sampleIntervals[statisticIndex] != -1) {
+			statistic->SetSampleInterval(statistic_sampleIntervals[statisticIndex]);
+		}
+
+		if (statistic_columnIntervals[statisticIndex] != -1) {
+			statistic->SetColumnInterval(statistic_columnIntervals[statisticIndex]);
+		}
+
+		if (statistic_reportIntervals[statisticIndex] != -1) {
+			statistic->SetReportInterval(statistic_reportIntervals[statisticIndex]);
+		}
+	}
+
 	return newRegion;
 }
 
@@ -934,7 +1090,7 @@ InputSpace *NetworkManager::ParseInputSpace(QXmlStreamReader &_xml, QString &_er
 	}
   
 	// Create the new InputSpace
-	newInputSpace = new InputSpace(id, sizeX, sizeY, numValues, patterns);
+	newInputSpace = new InputSpace(id.toStdString(), sizeX, sizeY, numValues, patterns);
 
 	return newInputSpace;
 }
@@ -1172,14 +1328,57 @@ PatternInfo *NetworkManager::ParsePattern(QXmlStreamReader &_xml, QString &_erro
 		_xml.readNext();
 	}
 
-	return new PatternInfo(patternType, startTime, endTime, patternMinTrialDuration, patternMaxTrialDuration, patternString, patternImageMotion, bitmaps, images);
+	// Render each character of a text pattern's string into its own bitmap.
+	if (patternType == PATTERN_TEXT) {
+		RenderTextBitmaps(patternString, _width, _height, bitmaps);
+	}
+
+	return new PatternInfo(patternType, startTime, endTime, patternMinTrialDuration, patternMaxTrialDuration, patternString.toStdString(), patternImageMotion, bitmaps, images);
+}
+
+/// Render each character of the given _string, centered, into a new _width x _height bitmap, and 
+/// append those bitmaps to _bitmaps. This is done once when the network is loaded, so that 
+/// InputSpace can apply text patterns without depending on Qt's painting classes.
+void NetworkManager::RenderTextBitmaps(QString &_string, int _width, int _height, std::vector<int*> &_bitmaps)
+{
+	float scale = 0.8 * ((float)_height / 8.0f);
+
+	// Create the image and painter that each character will be drawn with.
+	QImage image(_width, _height, QImage::Format_Mono);
+	QPainter painter(&image);
+	painter.setPen(QColor(255,255,255));
+	painter.setFont(QFont("Times", 10, QFont::Bold));
+	painter.scale(scale, scale);
+
+	for (int i = 0; i < _string.length(); i++)
+	{
+		// Draw the current character to the image.
+		image.fill(0);
+		painter.drawText(QRect(0, 0, (float)_width / scale, (float)_height / scale), Qt::AlignCenter, _string.mid(i, 1)); 
+
+		// Create an int array for the current character's bitmap.
+		int *bitmap_array = new int[_width * _height];
+		memset(bitmap_array, 0, _width * _height * sizeof(int));
+		_bitmaps.push_back(bitmap_array);
+
+		// Record which pixels of the image were drawn to.
+		for (int y = 0; y < _height; y++)
+		{
+			for (int x = 0; x < _width; x++)
+			{
+				if (QColor(image.pixel(x,y)).lightness() >= 128) {
+					bitmap_array[y * _width + x] = 1;
+				}
+			}
+		}
+	}
 }
 
 Classifier *NetworkManager::ParseClassifier(QXmlStreamReader &_xml, QString &_error_msg)
 {
 	QString inputspaceID(""), regionID(""), id("");
 	int numitems = -1;
-	QStringList labels;
+	std::vector<std::string> labels;
 
 	// Look for attributes
 	QXmlStreamAttributes attributes = _xml.attributes();
@@ -1206,8 +1405,10 @@ Classifier *NetworkManager::ParseClassifier(QXmlStreamReader &_xml, QString &_er
 
 	if (attributes.hasAttribute("labels")) 
 	{
-		QString labels_string = attributes.value("labels").toString();
-		labels = labels_string.split(",");
+		QStringList labels_list = attributes.value("labels").toString().split(",");
+		for (int i = 0; i < labels_list.size(); i++) {
+			labels.push_back(labels_list[i].toStdString());
+		}
 	}
 
 	if (id == "") 
@@ -1245,7 +1446,7 @@ Classifier *NetworkManager::ParseClassifier(QXmlStreamReader &_xml, QString &_er
 		_xml.readNext();
 	}	
 
-	return new Classifier(id, numitems, regionID, inputspaceID, labels);
+	return new Classifier(id.toStdString(), numitems, regionID.toStdString(), inputspaceID.toStdString(), labels);
 }
 
 void NetworkManager::ReadItem(char* &_linePos, char _separator, char *_stringBuffer, int _stringBufferLen)
@@ -1277,6 +1478,9 @@ void NetworkManager::ClearData()
 	{
 		region = regions[regionIndex];
 
+		// The frozen tables would no longer match the Region's synapses.
+		region->Unfreeze();
+
 		// Iterate through each column.
 		for (int colIndex = 0; colIndex < (region->GetSizeX() * region->GetSizeY()); colIndex++)
 		{
@@ -1302,6 +1506,10 @@ void NetworkManager::ClearData()
 				}				
 			}
 		}
+
+		// No proximal synapses remain, so every receptive field and proximal input index is now empty.
+		region->InitializeReceptiveFields();
+		region->InitializeProximalInputIndices();
 	}
 }
 
@@ -1317,17 +1525,14 @@ void NetworkManager::ClearData_ProximalSegment(Segment *_segment)
 
 void NetworkManager::ClearData_DistalSegment(Segment *_segment)
 {
-	while (_segment->Synapses.Count() > 0)
-	{
-		// Remove and release the current distal synapse.
-		mem_manager.ReleaseObject((DistalSynapse*)(_segment->Synapses.GetFirst()));
-		_segment->Synapses.RemoveFirst();
-	}
+	// Remove all of the distal synapses.
+	_segment->RemoveAllDistalSynapses();
 }
 
 bool NetworkManager::LoadData(QString &_filename, QFile *_file, QString &_error_msg)
 {
 	int numRegions, width, height, cellsPerCol, numDistalSegments;
+	float overlapDutyCycle, activeDutyCycle, fastActiveDutyCycle;
 	Region *region;
 	Column *column;
 	Cell *cell;
@@ -1371,9 +1576,10 @@ bool NetworkManager::LoadData(QString &_filename, QFile *_file, QString &_error_
 			column = region->Columns[colIndex];
 					
 			// Read the column's data.
-			stream >> column->_overlapDutyCycle;
-			stream >> column->ActiveDutyCycle;
-			stream >> column->FastActiveDutyCycle;
+			stream >> overlapDutyCycle;
+			stream >> activeDutyCycle;
+			stream >> fastActiveDutyCycle;
+			region->SetDutyCycles(colIndex, overlapDutyCycle, activeDutyCycle, fastActiveDutyCycle);
 			stream >> column->MinBoost;
 			stream >> column->MaxBoost;
 			stream >> column->Boost;
@@ -1399,6 +1605,7 @@ bool NetworkManager::LoadData(QString &_filename, QFile *_file, QString &_error_
 				{
 					// Create the new distal segment.
 					segment = (Segment*)(mem_manager.GetObject(MOT_SEGMENT));
+					segment->Initialize(cell, region->GetEpochCounter(), region->GetStepCounter(), (float)(region->SegActiveThreshold));
 					cell->Segments.InsertAtEnd(segment);
 
 					// Read the current distal segment's data.
@@ -1412,6 +1619,10 @@ bool NetworkManager::LoadData(QString &_filename, QFile *_file, QString &_error_
 				}				
 			}
 		}
+
+		// Determine the receptive field sizes of the loaded proximal synapses, and index them by their input values.
+		region->InitializeReceptiveFields();
+		region->InitializeProximalInputIndices();
 	}
 
 	return true;
@@ -1425,6 +1636,9 @@ bool NetworkManager::LoadData_ProximalSegment(QDataStream &_stream, Region *_reg
 	_stream >> _segment->PrevConnectedSynapsesCount;
 	_stream >> _segment->ActiveThreshold;
 
+	// Setting the number of prediction steps again determines whether the segment is a sequence segment.
+	_segment->SetNumPredictionSteps(_segment->_numPredictionSteps);
+
 	// Record the number of synapses.
 	int numSynapses;
 	_stream >> numSynapses;
@@ -1437,7 +1651,7 @@ bool NetworkManager::LoadData_ProximalSegment(QDataStream &_stream, Region *_reg
 	for (int i = 0; i < numSynapses; i++)
 	{
 		syn = (ProximalSynapse*)(mem_manager.GetObject(MOT_PROXIMAL_SYNAPSE));
-		syn->Initialize(&(_region->DistalSynapseParams));
+		syn->Initialize(&(_region->ProximalSynapseParams));
 		_segment->Synapses.InsertAtEnd(syn);
 
 		_stream >> perm;
@@ -1470,6 +1684,8 @@ bool NetworkManager::LoadData_ProximalSegment(QDataStream &_stream, Region *_reg
 			return false;
 		}
 
+		syn->BindInput();
+
 		// Read this Synapse's DistanceToInput.
 		_stream >> syn->DistanceToInput;
 	}
@@ -1489,17 +1705,11 @@ bool NetworkManager::LoadData_DistalSegment(QDataStream &_stream, Region *_regio
 	int numSynapses;
 	_stream >> numSynapses;
 
-	DistalSynapse *syn;
 	float perm;
 	int inputX, inputY, inputIndex;
 	for (int i = 0; i < numSynapses; i++)
 	{
-		syn = (DistalSynapse*)(mem_manager.GetObject(MOT_DISTAL_SYNAPSE));
-		syn->Initialize(&(_region->DistalSynapseParams));
-		_segment->Synapses.InsertAtEnd(syn);
-
 		_stream >> perm;
-		syn->SetPermanence(perm);
 
 		// Read this Synapse's input coordinates.
 		_stream >> inputX;
@@ -1514,8 +1724,8 @@ bool NetworkManager::LoadData_DistalSegment(QDataStream &_stream, Region *_regio
 			return false;
 		}
 
-		// Store pointer to this Synapse's input source Cell.
-		syn->InputSource = _region->GetColumn(inputX, inputY)->GetCellByIndex(inputIndex);
+		// Create the synapse from its input source Cell, adding the segment to that Cell's OutputSegments.
+		_segment->CreateDistalSynapse(_region->GetColumn(inputX, inputY)->GetCellByIndex(inputIndex), perm);
 	}
 
 	return true;
@@ -1529,6 +1739,9 @@ bool NetworkManager::SaveData(QString &_filename, QFile *_file, QString &_error_
 
 	QDataStream stream(_file);
 
+	// The proximal synapses' permanences are saved from the ProximalSynapse objects.
+	StoreProximalPermanences();
+
 	// Write number of Regions
 	stream << (int)(regions.size());
 
@@ -1615,58 +1828,41 @@ bool NetworkManager::SaveData_DistalSegment(QDataStream &_stream, Segment *_segm
 	_stream << _segment->GetActiveThreshold();
 
 	// Record the number of synapses.
-	_stream << _segment->Synapses.Count();
+	_stream << _segment->GetNumDistalSynapses();
 
-	FastListIter synIter(_segment->Synapses);
-	DistalSynapse *syn;
-	for (syn = (DistalSynapse*)(synIter.Reset()); syn != NULL; syn = (DistalSynapse*)(synIter.Advance()))
+	Cell *inputCell;
+	for (int i = 0; i < _segment->GetNumDistalSynapses(); i++)
 	{
-		_stream << syn->GetPermanence();
-		_stream << syn->GetInputSource()->GetColumn()->Position.X;
-		_stream << syn->GetInputSource()->GetColumn()->Position.Y;
-		_stream << syn->GetInputSource()->GetIndex();
+		inputCell = _segment->GetSynapseInputCell(i);
+		_stream << _segment->GetSynapsePermanence(i);
+		_stream << inputCell->GetColumn()->Position.X;
+		_stream << inputCell->GetColumn()->Position.Y;
+		_stream << inputCell->GetIndex();
 	}
 
 	return true;
 }
 
-DataSpace *NetworkManager::GetDataSpace(const QString _id)
+DataSpace *NetworkManager::GetDataSpace(const std::string &_id)
 {
-	InputSpace *inputspace = GetInputSpace(_id);
-
-	if (inputspace != NULL) {
-		return inputspace;
-	}
+	// Look up the InputSpace or Region with the given _id.
+	std::unordered_map<std::string, DataSpace*>::const_iterator iter = dataSpaceMap.find(_id);
 
-	Region *region = GetRegion(_id);
-
-	return region;
+	return (iter == dataSpaceMap.end()) ? NULL : iter->second;
 }
 
-InputSpace *NetworkManager::GetInputSpace(const QString _id)
+InputSpace *NetworkManager::GetInputSpace(const std::string &_id)
 {
-	// Look for a match to the given _id among the InputSpaces.
-	for (std::vector<InputSpace*>::const_iterator input_iter = inputSpaces.begin(), end = inputSpaces.end(); input_iter != end; ++input_iter) 
-	{
-		if ((*input_iter)->GetID() == _id) {
-			return (*input_iter);
-		}
-	}
+	DataSpace *dataSpace = GetDataSpace(_id);
 
-	return NULL;
+	return ((dataSpace != NULL) && (dataSpace->GetDataSpaceType() == DATASPACE_TYPE_INPUTSPACE)) ? (InputSpace*)dataSpace : NULL;
 }
 
-Region *NetworkManager::GetRegion(const QString _id)
+Region *NetworkManager::GetRegion(const std::string &_id)
 {
-	// Look for a match to the given _id among the Regions.
-	for (std::vector<Region*>::const_iterator region_iter = regions.begin(), end = regions.end(); region_iter != end; ++region_iter) 
-	{
-		if ((*region_iter)->GetID() == _id) {
-			return (*region_iter);
-		}
-	}
+	DataSpace *dataSpace = GetDataSpace(_id);
 
-	return NULL;
+	return ((dataSpace != NULL) && (dataSpace->GetDataSpaceType() == DATASPACE_TYPE_REGION)) ? (Region*)dataSpace : NULL;
 }
 
 void NetworkManager::Step()
@@ -1685,12 +1881,70 @@ void NetworkManager::Step()
 	}
 }
 
-void NetworkManager::WriteToLog(QString _text)
+/// Run _numSteps time steps of the network, with no UI involvement. If a _callback is given, it 
+/// is called (with _userData) after every _interval steps, and after the final step. The callback 
+/// may return false to stop execution early. Returns the number of steps that were run.
+int NetworkManager::StepN(int _numSteps, StepCallback _callback, void *_userData, int _interval)
 {
-	QFile file("log.txt");
-	if ( file.open(QIODevice::Append) )
+	int stepCount;
+
+	// An interval below 1 means the callback is only called after the final step.
+	if (_interval < 1) {
+		_interval = _numSteps;
+	}
+
+	for (stepCount = 0; stepCount < _numSteps;)
 	{
-			QTextStream stream( &file );
-			stream << _text << endl;
+		// Execute one step for the network.
+		Step();
+		stepCount++;
+
+		// If a full interval has passed (or this is the last step), call the callback. Stop if it returns false.
+		if ((_callback != NULL) && (((stepCount % _interval) == 0) || (stepCount == _numSteps)))
+		{
+			if (_callback(this, _userData) == false) {
+				break;
+			}
+		}
+	}
+
+	return stepCount;
+}
+
+/// Discard the step phase timings recorded so far by each Region's StepProfiler.
+void NetworkManager::ResetProfilers()
+{
+	for (std::vector<Region*>::const_iterator region_iter = regions.begin(), end = regions.end(); region_iter != end; ++region_iter) {
+		(*region_iter)->GetProfiler().Reset();
 	}
 }
+
+/// Freeze every Region for inference only (see Region::Freeze()). Must only be called between time steps.
+void NetworkManager::Freeze()
+{
+	for (std::vector<Region*>::const_iterator region_iter = regions.begin(), end = regions.end(); region_iter != end; ++region_iter) {
+		(*region_iter)->Freeze();
+	}
+}
+
+/// Return every frozen Region to normal operation. Must only be called between time steps.
+void NetworkManager::Unfreeze()
+{
+	for (std::vector<Region*>::const_iterator region_iter = regions.begin(), end = regions.end(); region_iter != end; ++region_iter) {
+		(*region_iter)->Unfreeze();
+	}
+}
+
+/// Bring the permanences of every Region's ProximalSynapse objects up to date, so that they may be 
+/// read directly. Must only be called between time steps.
+void NetworkManager::StoreProximalPermanences()
+{
+	for (std::vector<Region*>::const_iterator region_iter = regions.begin(), end = regions.end(); region_iter != end; ++region_iter) {
+		(*region_iter)->StoreProximalPermanences();
+	}
+}
+
+void NetworkManager::WriteToLog(QString _text)
+{
+	::WriteToLog(_text.toStdString());
+}
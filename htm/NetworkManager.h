@@ -2,6 +2,8 @@
 #include <QtCore/QFile>
 #include <QtCore/QXmlStreamReader>
 #include <list>
+#include <string>
+#include <unordered_map>
 #include "Region.h"
 #include "InputSpace.h"
 #include "Classifier.h"
@@ -12,6 +14,12 @@ const int INPUTSPACE_MAX_NUM_VALUES = 1000;
 const int STRING_BUFFER_LEN = 100;
 const int LINE_BUFFER_LEN = 10000;
 
+class NetworkManager;
+
+/// Function called by NetworkManager::StepN() after every interval of time steps. Returning
+/// false stops execution before the requested number of steps has been run.
+typedef bool (*StepCallback)(NetworkManager *_networkManager, void *_userData);
+
 class NetworkManager
 {
 public:
@@ -25,6 +33,7 @@ public:
 	Region *ParseRegion(QXmlStreamReader &_xml, SynapseParameters _proximalSynapseParams, SynapseParameters _distalSynapseParams, QString &_error_msg);
 	InputSpace *ParseInputSpace(QXmlStreamReader &_xml, QString &_error_msg);
 	PatternInfo *ParsePattern(QXmlStreamReader &_xml, QString &_error_msg, int _width, int _height);
+	void RenderTextBitmaps(QString &_string, int _width, int _height, std::vector<int*> &_bitmaps);
 	Classifier *ParseClassifier(QXmlStreamReader &_xml, QString &_error_msg);
 	void ReadItem(char* &_linePos, char _separator, char *_stringBuffer, int _stringBufferLen);
 
@@ -44,11 +53,19 @@ public:
 	int GetTime() {return time;}
 	bool IsNetworkLoaded() {return networkLoaded;}
 
-	DataSpace *GetDataSpace(const QString _id);
-	InputSpace *GetInputSpace(const QString _id);
-	Region *GetRegion(const QString _id);
+	DataSpace *GetDataSpace(const std::string &_id);
+	InputSpace *GetInputSpace(const std::string &_id);
+	Region *GetRegion(const std::string &_id);
 
 	void Step();
+	int StepN(int _numSteps, StepCallback _callback = NULL, void *_userData = NULL, int _interval = 1);
+
+	void ResetProfilers();
+
+	void Freeze();
+	void Unfreeze();
+
+	void StoreProximalPermanences();
 
 	void WriteToLog(QString _text);
 
@@ -56,6 +73,9 @@ public:
 	std::vector<Region*> regions;
 	std::vector<Classifier*> classifiers;
 
+	// Maps the ID of each InputSpace and Region to that DataSpace, for fast lookup by ID.
+	std::unordered_map<std::string, DataSpace*> dataSpaceMap;
+
 	QString filename;
 	int time;
 	bool networkLoaded;
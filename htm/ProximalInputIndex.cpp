@@ -0,0 +1,112 @@
+#include "ProximalInputIndex.h"
+#include "DataSpace.h"
+#include "Column.h"
+
+ProximalInputIndex::ProximalInputIndex(DataSpace *_input)
+	: input(_input), frozen(false)
+{
+}
+
+/// Returns true if the given proximal synapse belongs in an index of the given kind. A frozen index only
+/// needs the synapses that can contribute to their Columns' overlaps.
+static bool IsIndexed(Column *_col, int _synIndex, bool _frozen)
+{
+	return (_frozen == false) || _col->ProximalConnected[_synIndex] || _col->ProximalWellConnected[_synIndex];
+}
+
+/// Build the index from the proximal synapses of the given Columns that sample this index's input.
+/// If _frozen is true, the synapses' permanences must no longer change; only those that are connected
+/// or well connected are included, along with those states.
+void ProximalInputIndex::Build(Column **_columns, int _numColumns, bool _frozen)
+{
+	int numValues = input->GetSizeX() * input->GetSizeY() * input->GetNumValues();
+	int colIndex, synIndex, valueIndex;
+	const BitArray *inputBits = &(input->GetActiveBits());
+	Column *col;
+
+	frozen = _frozen;
+
+	// Count the synapses sampling each input value, leaving room for the end offset.
+	offsets.assign(numValues + 1, 0);
+	for (colIndex = 0; colIndex < _numColumns; colIndex++)
+	{
+		col = _columns[colIndex];
+		for (synIndex = 0; synIndex < col->NumProximalSynapses; synIndex++)
+		{
+			if ((col->ProximalInputBits[synIndex] == inputBits) && IsIndexed(col, synIndex, frozen)) {
+				offsets[col->ProximalInputValues[synIndex] + 1]++;
+			}
+		}
+	}
+
+	// Convert the counts into the offset at which each value's entries begin.
+	for (valueIndex = 0; valueIndex < numValues; valueIndex++) {
+		offsets[valueIndex + 1] += offsets[valueIndex];
+	}
+
+	// Fill in the entries, using the offsets of the values' next free entries (in the copy) as they are filled.
+	std::vector<int> nextEntry(offsets.begin(), offsets.end() - 1);
+	entries.resize(offsets[numValues]);
+	for (colIndex = 0; colIndex < _numColumns; colIndex++)
+	{
+		col = _columns[colIndex];
+		for (synIndex = 0; synIndex < col->NumProximalSynapses; synIndex++)
+		{
+			if ((col->ProximalInputBits[synIndex] == inputBits) && IsIndexed(col, synIndex, frozen)) 
+			{
+				ProximalInputEntry &entry = entries[nextEntry[col->ProximalInputValues[synIndex]]++];
+				entry.column = col;
+				entry.synapseIndex = synIndex;
+				entry.connected = col->ProximalConnected[synIndex];
+				entry.wellConnected = col->ProximalWellConnected[synIndex];
+			}
+		}
+	}
+}
+
+/// For each currently active value of the input, add the synapses that sample it to their Columns'
+/// active synapse counts. The input's active bits must already have been determined for this time step.
+void ProximalInputIndex::AccumulateActiveSynapses()
+{
+	Column *col;
+	BitWord word;
+	int valueIndex, synIndex;
+
+	const BitArray &activeBits = input->GetActiveBits();
+
+	for (int wordIndex = 0; wordIndex < activeBits.GetNumWords(); wordIndex++)
+	{
+		// Visit each set bit of the word, clearing the lowest set bit each time. Words with no active values are skipped at once.
+		for (word = activeBits.GetWord(wordIndex); word != 0; word &= (word - 1))
+		{
+			valueIndex = (wordIndex * BITS_PER_WORD) + LowestSetBit(word);
+
+			if (frozen)
+			{
+				// The states recorded in the entries are current, so the Columns' own arrays needn't be read.
+				for (int entryIndex = offsets[valueIndex]; entryIndex < offsets[valueIndex + 1]; entryIndex++)
+				{
+					col = entries[entryIndex].column;
+					col->ActiveConnectedSynapsesCount += entries[entryIndex].connected;
+					col->ActiveWellConnectedSynapsesCount += entries[entryIndex].wellConnected;
+				}
+			}
+			else
+			{
+				for (int entryIndex = offsets[valueIndex]; entryIndex < offsets[valueIndex + 1]; entryIndex++)
+				{
+					col = entries[entryIndex].column;
+					synIndex = entries[entryIndex].synapseIndex;
+
+					if (col->ProximalConnected[synIndex]) {
+						col->ActiveConnectedSynapsesCount++;
+					}
+
+					if (col->ProximalWellConnected[synIndex]) {
+						col->ActiveWellConnectedSynapsesCount++;
+					}
+				}
+			}
+		}
+	}
+}
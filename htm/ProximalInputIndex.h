@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+
+class DataSpace;
+class Column;
+
+// One proximal synapse that samples an input value: the Column it belongs to, and its index within
+// that Column's arrays of proximal synapse state. In a frozen index, whether the synapse is connected
+// and well connected are also recorded here, since they can no longer change.
+struct ProximalInputEntry
+{
+	Column *column;
+	int synapseIndex;
+	unsigned char connected, wellConnected;
+};
+
+/// Maps each value of one input DataSpace to the proximal synapses of a Region that sample it.
+///
+/// Input activity is sparse, so a Region's overlaps are accumulated by visiting only the synapses
+/// of the input values that are currently active, rather than every proximal synapse. The active
+/// values are found by scanning the input's packed activity bits, a word at a time.
+class ProximalInputIndex
+{
+public:
+	ProximalInputIndex(DataSpace *_input);
+
+	DataSpace *GetInput() {return input;}
+
+	/// Build the index from the proximal synapses of the given Columns that sample this index's input.
+	/// If _frozen is true, the synapses' permanences must no longer change; only those that are connected
+	/// or well connected are included, along with those states.
+	void Build(Column **_columns, int _numColumns, bool _frozen);
+
+	/// For each currently active value of the input, add the synapses that sample it to their Columns'
+	/// active synapse counts. The input's active bits must already have been determined for this time step.
+	void AccumulateActiveSynapses();
+
+private:
+
+	DataSpace *input;
+
+	// Whether the index was built from permanences that no longer change.
+	bool frozen;
+
+	// The entries for input value i are entries[offsets[i]] to entries[offsets[i + 1] - 1].
+	std::vector<int> offsets;
+	std::vector<ProximalInputEntry> entries;
+};
@@ -24,7 +24,7 @@ bool ProximalSynapse::GetIsActive()
 /// inputSource: A DataSource (external data source, or another Region) providing source of the input to this synapse.
 /// inputPoint: Coordinates and value index of this synapse's input within the inputSource. 
 /// permanence: Initial permanence value.
-/// distanceToInput: In the Region's hypercolumn coordinates; used by Region::AverageReceptiveFieldSize().
+/// distanceToInput: In the Region's hypercolumn coordinates; used to determine the Column's receptive field size.
 void ProximalSynapse::Initialize(SynapseParameters *params, DataSpace *inputSource, DataPoint &inputPoint, float permanence, float distanceToInput)
 {
 	Synapse::Initialize(params);
@@ -32,6 +32,9 @@ void ProximalSynapse::Initialize(SynapseParameters *params, DataSpace *inputSour
 	InputSource = inputSource;
 	InputPoint = inputPoint;
 	DistanceToInput = distanceToInput;
+	DistanceIndex = 0;
+
+	BindInput();
 
 	SetPermanence(permanence);
 }
@@ -44,6 +47,16 @@ void ProximalSynapse::Initialize(SynapseParameters *params)
 	InputSource = NULL;
 	InputPoint = DataPoint();
 	DistanceToInput = 0.0f;
+	DistanceIndex = 0;
+	InputBits = NULL;
+	InputValueIndex = 0;
 
 	SetPermanence(0.0f);
 }
+
+/// Bind this synapse to the activity bits of its InputSource, once InputSource and InputPoint are set.
+void ProximalSynapse::BindInput()
+{
+	InputBits = &(InputSource->GetActiveBits());
+	InputValueIndex = InputSource->GetValueIndex(InputPoint.X, InputPoint.Y, InputPoint.Index);
+}
@@ -28,6 +28,13 @@ public:
 	// Distance, in this synapse's Region's space, to its input DataPoint.
 	float DistanceToInput;
 
+	// Index of DistanceToInput within its Column's list of distinct receptive field distances.
+	int DistanceIndex;
+
+	// The packed activity bits of InputSource, and the index of InputPoint's bit within them.
+	const BitArray *InputBits;
+	int InputValueIndex;
+
 	/// Returns true if this ProximalSynapse is active due to the current input.
 	virtual bool GetIsActive();
 
@@ -38,8 +45,11 @@ public:
 	/// inputSource: A DataSource (external data source, or another Region) providing source of the input to this synapse.
 	/// inputPoint: Coordinates and value index of this synapse's input within the inputSource. 
 	/// permanence: Initial permanence value.
-	/// distanceToInput: In the Region's coordinates; used by Region::AverageReceptiveFieldSize().
+	/// distanceToInput: In the Region's coordinates; used to determine the Column's receptive field size.
 	void Initialize(SynapseParameters *params, DataSpace *inputSource, DataPoint &inputPoint, float permanence, float distanceToInput);
 	void Initialize(SynapseParameters *params);
+
+	/// Bind this synapse to the activity bits of its InputSource, once InputSource and InputPoint are set.
+	void BindInput();
 };
 
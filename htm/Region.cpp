@@ -1,12 +1,28 @@
 #include "Region.h"
-#include "NetworkManager.h"
+#include "Log.h"
+#include "Timer.h"
 #include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <ctype.h>
+#include <algorithm>
+#include <functional>
 #include <crtdbg.h>
 #include "Utils.h"
 #include "Cell.h"
 
 Region::~Region(void)
 {
+	// Release every cell's distal segments before deleting any column. Releasing a segment removes it from
+	// the OutputSegments of its synapses' input cells, which may belong to any column.
+	for (int colIndex = 0; colIndex < Width * Height; colIndex++)
+	{
+		for (int cellIndex = 0; cellIndex < CellsPerCol; cellIndex++) {
+			Columns[colIndex]->Cells[cellIndex]->ReleaseSegments();
+		}
+	}
+
 	// Delete all columns.
 	for (int cy = 0; cy < Height; cy++)
 	{
@@ -20,6 +36,22 @@ Region::~Region(void)
 	// Delete the array of Column pointers.
 	delete Columns;
 
+	// Delete the proximal input indices.
+	for (std::vector<ProximalInputIndex*>::const_iterator index_iter = ProximalInputIndices.begin(), end = ProximalInputIndices.end(); index_iter != end; ++index_iter) {
+		delete (*index_iter);
+	}
+
+	// Stop and delete the spatial pooling workers.
+	delete SpatialPoolingWorkers;
+
+	// Delete the array of inhibition thresholds.
+	delete [] InhibitionThresholds;
+
+	// Delete the Statistics.
+	for (std::vector<Statistic*>::const_iterator statistic_iter = Statistics.begin(), end = Statistics.end(); statistic_iter != end; ++statistic_iter) {
+		delete (*statistic_iter);
+	}
+
 	InputIDs.clear();
 	InputList.clear();
 }
@@ -79,7 +111,7 @@ Region::~Region(void)
 /// in the overall input space (which hopefully higher hierarchical Regions would 
 /// handle more successfully).  Passing in -1 for input radius will mean no 
 /// restriction which will more closely follow the Numenta doc if desired.
-Region::Region(NetworkManager *manager, QString &_id, Point colGridSize, int hypercolumnDiameter, SynapseParameters proximalSynapseParams, SynapseParameters distalSynapseParams, float pctInputPerCol, float pctMinOverlap, int predictionRadius, InhibitionTypeEnum inhibitionType, int inhibitionRadius, float pctLocalActivity, float boostRate, float maxBoost, int spatialLearningStartTime, int spatialLearningEndTime, int temporalLearningStartTime, int temporalLearningEndTime, int boostingStartTime, int boostingEndTime, int cellsPerCol, int segActiveThreshold, int newSynapseCount, int min_MinOverlapToReuseSegment, int max_MinOverlapToReuseSegment, bool hardcodedSpatial, bool outputColumnActivity, bool outputCellActivity)
+Region::Region(NetworkManager *manager, const std::string &_id, Point colGridSize, int hypercolumnDiameter, SynapseParameters proximalSynapseParams, SynapseParameters distalSynapseParams, float pctInputPerCol, float pctMinOverlap, int predictionRadius, InhibitionTypeEnum inhibitionType, int inhibitionRadius, float pctLocalActivity, float boostRate, float maxBoost, int spatialLearningStartTime, int spatialLearningEndTime, int temporalLearningStartTime, int temporalLearningEndTime, int boostingStartTime, int boostingEndTime, int cellsPerCol, int segActiveThreshold, int newSynapseCount, int min_MinOverlapToReuseSegment, int max_MinOverlapToReuseSegment, bool hardcodedSpatial, bool outputColumnActivity, bool outputCellActivity)
 	: DataSpace(_id)
 {
 	//this.Predictions = new BindingList<Prediction>();
@@ -88,6 +120,22 @@ Region::Region(NetworkManager *manager, QString &_id, Point colGridSize, int hyp
 	Width = (int)(colGridSize.X);
 	Height = (int)(colGridSize.Y);
 	HypercolumnDiameter = hypercolumnDiameter;
+	HypercolumnsX = (Width + HypercolumnDiameter - 1) / HypercolumnDiameter;
+	HypercolumnsY = (Height + HypercolumnDiameter - 1) / HypercolumnDiameter;
+	DesiredLocalActivityRadius = -1;
+	NumThreads = 1;
+	SpatialPoolingWorkers = NULL;
+	SpatialLearningAllowed = false;
+	BoostingAllowed = false;
+	InhibitionOverlaps.resize(1);
+	ReceptiveFieldSizeSum = 0.0;
+	ReceptiveFieldSizeDeltas.resize(1, 0.0);
+	Frozen = false;
+	Epoch = 0;
+	PrevLearningCellsEpoch = -1;
+	LazyDutyCycles = false;
+	DutyCycleTime = 0;
+	SpatialLearningWindow = 1;
 	ProximalSynapseParams = proximalSynapseParams;
 	DistalSynapseParams = distalSynapseParams;
 	PredictionRadius = predictionRadius;
@@ -115,6 +163,24 @@ Region::Region(NetworkManager *manager, QString &_id, Point colGridSize, int hyp
 
 	// Determine number of output values.
 	NumOutputValues = (OutputColumnActivity ? 1 : 0) + (OutputCellActivity ? CellsPerCol : 0);
+
+	// Create the array of bits representing each output value's activity.
+	activeBits.Resize(Width * Height * NumOutputValues);
+
+	// Create the arrays of the Columns' duty cycles, which begin at 1.
+	ActiveDutyCycles.resize(Width * Height, 1.0f);
+	FastActiveDutyCycles.resize(Width * Height, 1.0f);
+	OverlapDutyCycles.resize(Width * Height, 1.0f);
+	ActiveDutyCycleInputs.resize(Width * Height, 0.0f);
+	OverlapDutyCycleInputs.resize(Width * Height, 0.0f);
+	DutyCycleTimes.resize(Width * Height, 0);
+
+	// Create the buffers of the cells' states, all initially inactive.
+	CellStates.Resize(Width * Height * CellsPerCol);
+
+	// Create the index of previously learning cells, and the buffers used in choosing cells to form new synapses from.
+	PrevLearningCellsStart.resize(Width * Height + 1, 0);
+	SynapseCellMarks.Resize(Width * Height * CellsPerCol);
 	
 	// Create the columns based on the size of the input data to connect to.
 	int minOverlapToReuseSegment;
@@ -130,6 +196,25 @@ Region::Region(NetworkManager *manager, QString &_id, Point colGridSize, int hyp
 			Columns[(cy * Width) + cx] = new Column(this, Point(cx, cy), minOverlapToReuseSegment);
 		}
 	}
+
+	// Create the buffers used to find the maximum duty cycle around each hypercolumn.
+	NeighborhoodMaxDutyCycles.resize(HypercolumnsX * HypercolumnsY, 0.0f);
+	HypercolumnMaxDutyCycles.resize(HypercolumnsX * HypercolumnsY, 0.0f);
+	RowMaxDutyCycles.resize(HypercolumnsX * HypercolumnsY, 0.0f);
+	MaxDutyCycleQueue.resize(Max(HypercolumnsX, HypercolumnsY));
+
+	// Create the array of inhibition thresholds, one per hypercolumn.
+	InhibitionThresholds = new float[HypercolumnsX * HypercolumnsY];
+	for (int i = 0; i < HypercolumnsX * HypercolumnsY; i++) {
+		InhibitionThresholds[i] = 0.0f;
+	}
+
+	// Add the standard Statistics. They are stepped on every time step, including while the Region is frozen, so by
+	// default each is only sampled every 10 time steps, and reported every 1000. Feature accuracy visits every proximal 
+	// synapse of the columns it examines. The others visit every cell, so they examine one in every 4 columns.
+	AddStatistic(new FeatureAccuracyStatistic(10, 1, 1000));
+	AddStatistic(new SparsityStatistic(10, 4, 1000));
+	AddStatistic(new PredictionHitRateStatistic(10, 4, 1000));
 }
 
 /// Methods
@@ -158,6 +243,52 @@ bool Region::GetIsActive(int _x, int _y, int _index)
 	}
 }
 
+const BitArray &Region::DetermineActiveBits()
+{
+	Column *col;
+	Cell *cell;
+	BitWord word = 0;
+	int bitIndex = 0, wordIndex = 0;
+
+	// Values are visited in the order of their indices, in the same way as GetIsActive() determines them,
+	// and packed a word at a time.
+	for (int ColIndex = 0; ColIndex < Width * Height; ColIndex++)
+	{
+		col = Columns[ColIndex];
+
+		for (int valueIndex = 0; valueIndex < NumOutputValues; valueIndex++)
+		{
+			if (OutputColumnActivity && (valueIndex == (NumOutputValues - 1))) 
+			{
+				if (col->GetIsActive()) {
+					word |= (BitWord)1 << bitIndex;
+				}
+			}
+			else
+			{
+				cell = col->Cells[valueIndex];
+				if (cell->GetIsActive() || cell->GetIsPredicting()) {
+					word |= (BitWord)1 << bitIndex;
+				}
+			}
+
+			if (++bitIndex == BITS_PER_WORD)
+			{
+				activeBits.SetWord(wordIndex++, word);
+				word = 0;
+				bitIndex = 0;
+			}
+		}
+	}
+
+	// Store the final, partial word.
+	if (bitIndex > 0) {
+		activeBits.SetWord(wordIndex, word);
+	}
+
+	return activeBits;
+}
+
 // Add an input DataSpace to this Region
 void Region::AddInput(DataSpace *_inputDataSpace)
 {
@@ -200,6 +331,14 @@ bool Region::IsCellLearning(int _x, int _y, int _index)
 	return col->GetCellByIndex(_index)->GetIsLearning();
 }
 
+/// Returns the cell with the given number, (ColIndex * CellsPerCol) + cellIndex (see Cell::GetNumber()).
+Cell *Region::GetCellByNumber(int _number)
+{
+	_ASSERT((_number >= 0) && (_number < (Width * Height * CellsPerCol)));
+
+	return Columns[_number / CellsPerCol]->Cells[_number % CellsPerCol];
+}
+
 Cell *Region::GetCell(int _x, int _y, int _index)
 {
 	_ASSERT((_x >= 0) && (_x < Width));
@@ -222,6 +361,10 @@ void Region::Initialize()
 			Columns[i]->CreateProximalSegments(InputList, InputRadii);
 		}
 
+		// Determine each Column's receptive field size, and index the proximal synapses by their input values.
+		InitializeReceptiveFields();
+		InitializeProximalInputIndices();
+
 		if (InhibitionType == INHIBITION_TYPE_AUTOMATIC)
 		{
 			// Initialize InhibitionRadius based on the average receptive field size.
@@ -229,9 +372,7 @@ void Region::Initialize()
 		}
 
 		// Determine the DesiredLocalActivity value for each Column, based on InhibitionRadius.
-		for (int ColIndex = 0; ColIndex < Width * Height; ColIndex++) {
-			Columns[ColIndex]->DetermineDesiredLocalActivity();
-		}
+		UpdateDesiredLocalActivity(true);
 	}
 
 	InitializeStatisticParameters();
@@ -276,6 +417,7 @@ void Region::PerformSpatialPooling()
 {
 	int ColIndex;
 	Column *col;
+	long long phaseStartTicks = GetTimerTicks();
 
 	if (HardcodedSpatial)
 	{
@@ -289,57 +431,85 @@ void Region::PerformSpatialPooling()
 				col->SetIsActive(inputDataSpace->GetIsActive(col->Position.X, col->Position.Y, 0) == 1);
 			}
 		}
+
+		// Copying the input's activity takes the place of computing overlap.
+		Profiler.EndPhase(STEP_PHASE_SP_OVERLAP, phaseStartTicks);
 		return;
 	}
 
-	// Determine whether spatial learning is currently allowed.
-	bool allowSpatialLearning= ((GetSpatialLearningStartTime() == -1) || (GetSpatialLearningStartTime() <= GetStepCounter())) &&
-		                         ((GetSpatialLearningEndTime() == -1) || (GetSpatialLearningEndTime() >= GetStepCounter()));
+	// Determine whether spatial learning is currently allowed. A frozen Region never learns.
+	SpatialLearningAllowed = (Frozen == false) && ((GetSpatialLearningStartTime() == -1) || (GetSpatialLearningStartTime() <= GetStepCounter())) &&
+		                       ((GetSpatialLearningEndTime() == -1) || (GetSpatialLearningEndTime() >= GetStepCounter()));
 
 	// Determine whether boosting is currently allowed.
-	bool allowBoosting= ((GetBoostingStartTime() == -1) || (GetBoostingStartTime() <= GetStepCounter())) &&
-		                  ((GetBoostingEndTime() == -1) || (GetBoostingEndTime() >= GetStepCounter()));
+	BoostingAllowed = (Frozen == false) && ((GetBoostingStartTime() == -1) || (GetBoostingStartTime() <= GetStepCounter())) &&
+		                ((GetBoostingEndTime() == -1) || (GetBoostingEndTime() >= GetStepCounter()));
+
+	// Each phase's work on the columns is shared among the spatial pooling workers, each taking its own 
+	// contiguous range of columns (or hypercolumns). Every worker finishes a phase before the next begins.
 
 	// Phase 1: Compute Input Overlap
-	for (ColIndex = 0; ColIndex < Width * Height; ColIndex++)
-	{
-		Columns[ColIndex]->ComputeOverlap();
+	// Each input's activity is determined once, before the workers read it.
+	for (std::vector<DataSpace*>::const_iterator input_iter = InputList.begin(), end = InputList.end(); input_iter != end; ++input_iter) {
+		(*input_iter)->DetermineActiveBits();
 	}
 
+	RunSpatialPoolingWorkers(ComputeOverlapWorker);
+
+	phaseStartTicks = Profiler.EndPhase(STEP_PHASE_SP_OVERLAP, phaseStartTicks);
+
 	// Phase 2: Compute active columns (Winners after inhibition)
-	for (ColIndex = 0; ColIndex < Width * Height; ColIndex++)
-	{
-		Columns[ColIndex]->ComputeColumnInhibition();
+	// If the inhibition area is the whole Region, a single threshold is found in linear time.
+	if (IsInhibitionGlobal()) {
+		ComputeGlobalInhibitionThreshold();
+	} else {
+		RunSpatialPoolingWorkers(ComputeInhibitionThresholdsWorker);
+	}
+
+	RunSpatialPoolingWorkers(ComputeColumnInhibitionWorker);
+
+	phaseStartTicks = Profiler.EndPhase(STEP_PHASE_SP_INHIBITION, phaseStartTicks);
+
+	// A frozen Region's permanences, duty cycles and boosts no longer change.
+	if (Frozen) {
+		return;
 	}
 
 	// Phase 3: Synapse Learning and Determining Boosting
-	for (ColIndex = 0; ColIndex < Width * Height; ColIndex++)
-	{
-		col = Columns[ColIndex];
-		
-		if (allowSpatialLearning && col->GetIsActive())
-		{
-			col->AdaptPermanences();
-		}
+	// The maximum duty cycle around every hypercolumn is found at once, from the duty cycles as of the previous step.
+	// If duty cycles are updated lazily, the maximum is only needed while boosting is allowed.
+	if (BoostingAllowed || !LazyDutyCycles) {
+		ComputeMaxDutyCycles();
+	}
 
-		col->UpdateDutyCycles();
+	// The duty cycles are read as of this time step from here on.
+	DutyCycleTime = GetStepCounter();
 
-		if (allowBoosting) 
-		{
-			col->PerformBoosting();
-		}
+	RunSpatialPoolingWorkers(SpatialLearningWorker);
+
+	// Add each worker's change in its Columns' receptive field sizes to the sum, in order of worker index.
+	for (int workerIndex = 0; workerIndex < NumThreads; workerIndex++) {
+		ReceptiveFieldSizeSum += ReceptiveFieldSizeDeltas[workerIndex];
 	}
 
-	if (allowSpatialLearning && (InhibitionType == INHIBITION_TYPE_AUTOMATIC)) 
+	phaseStartTicks = Profiler.EndPhase(STEP_PHASE_SP_LEARNING, phaseStartTicks);
+
+	if (SpatialLearningAllowed && (InhibitionType == INHIBITION_TYPE_AUTOMATIC)) 
 	{
 		// Determine the new InhibitionRadius value based on average receptive field size.
 		InhibitionRadius = AverageReceptiveFieldSize();
 
-		// Determine the new DesiredLocalActivity value for each column.
-		for (ColIndex = 0; ColIndex < Width * Height; ColIndex++) {
-			Columns[ColIndex]->DetermineDesiredLocalActivity();
-		}
+		// Determine the new DesiredLocalActivity value for each column, if the inhibition area has changed.
+		UpdateDesiredLocalActivity(false);
 	}
+
+	Profiler.EndPhase(STEP_PHASE_SP_RADIUS_UPDATE, phaseStartTicks);
+}
+
+/// Returns true if the first given Cell's number within its Region is lower than the second's.
+static bool CompareCellNumbers(Cell *_a, Cell *_b)
+{
+	return _a->GetNumber() < _b->GetNumber();
 }
 
 /// Performs temporal pooling based on the current spatial pooler output.
@@ -410,10 +580,10 @@ void Region::PerformTemporalPooling()
 	bool predicted, learnCellChosen;
 	int ColIndex;
 	Column *col;
-	FastListIter segments_iter;
 	Cell *cell, *bestCell;
 	Segment *segment, *bestSegment, *seg, *predictiveSegment;
 	SegmentUpdateInfo *segmentUpdateInfo, *predictiveSegUpdate;
+	long long phaseStartTicks = GetTimerTicks();
 
 	// Determine whether temporal learning is currently allowed.
 	bool temporalLearning= ((GetTemporalLearningStartTime() == -1) || (GetTemporalLearningStartTime() <= GetStepCounter())) &&
@@ -440,7 +610,7 @@ void Region::PerformTemporalPooling()
 					{
 						predicted = true;
 						cell->SetIsActive(true);
-						if (TemporalLearning && segment->GetWasActiveFromLearning())
+						if (TemporalLearning && segment->GetWasActiveFromLearning(CellStates.Previous))
 						{
 							learnCellChosen = true;
 							cell->SetIsLearning(true);
@@ -450,19 +620,19 @@ void Region::PerformTemporalPooling()
 			}
 
 			// TESTING
-			if (id == QString("Region1"))
+			if (id == "Region1")
 			{
 				if ((col->Position.X == 32) && (col->Position.Y == 22)) 
 				{
-					QString stepString;
-					stepString.setNum(GetStepCounter());
-					Manager->WriteToLog(QString("Time ") + stepString + QString(": Cell 32,22,0 active.") + (predicted ? QString("Predicted.") : QString("")));
+					char logBuffer[LOG_BUFFER_LEN];
+					sprintf(logBuffer, "Time %d: Cell 32,22,0 active.%s", GetStepCounter(), predicted ? "Predicted." : "");
+					WriteToLog(logBuffer);
 				}
 				if ((col->Position.X == 32) && (col->Position.Y == 23)) 
 				{
-					QString stepString;
-					stepString.setNum(GetStepCounter());
-					Manager->WriteToLog(QString("Time ") + stepString + QString(": Cell 32,23,0 active.") + (predicted ? QString("Predicted.") : QString("")));
+					char logBuffer[LOG_BUFFER_LEN];
+					sprintf(logBuffer, "Time %d: Cell 32,23,0 active.%s", GetStepCounter(), predicted ? "Predicted." : "");
+					WriteToLog(logBuffer);
 				}
 			}
 
@@ -490,6 +660,8 @@ void Region::PerformTemporalPooling()
 			}
 		}
 	}
+
+	phaseStartTicks = Profiler.EndPhase(STEP_PHASE_TP_ACTIVE_STATE, phaseStartTicks);
 	
 	// Phase2
 	// 42. for c, i in cells
@@ -504,69 +676,101 @@ void Region::PerformTemporalPooling()
 	// 51.       predUpdate = getSegmentActiveSynapses(
 	// 52.                                   c, i, predSegment, t-1, true)
 	// 53.       segmentUpdateList.add(predUpdate)
+
+	// Determine the active synapses of every segment, by having each active cell touch the segments that it feeds, and
+	// then processing each touched segment once. Every other segment has no active synapses, so is inactive. 
+	// Only cells of active columns can be active.
+	TouchedSegments.clear();
+	PredictingCells.clear();
+
 	for (ColIndex = 0; ColIndex < Width * Height; ColIndex++)
 	{
 		col = Columns[ColIndex];
 
+		if (col->IsActive == false) {
+			continue;
+		}
+
 		for (int cellIndex = 0; cellIndex < GetCellsPerCol(); cellIndex++)
 		{
 			cell = col->Cells[cellIndex];
-	
-			// Process all segments on the cell to cache the activity for later.
-			segments_iter.SetList(cell->Segments);
-			for (seg = (Segment*)(segments_iter.Reset()); seg != NULL; seg = (Segment*)(segments_iter.Advance()))
+
+			if (cell->GetIsActive()) {
+				cell->ActivateOutputSegments(TouchedSegments);
+			}
+		}
+	}
+
+	for (std::vector<Segment*>::const_iterator seg_iter = TouchedSegments.begin(), end = TouchedSegments.end(); seg_iter != end; ++seg_iter)
+	{
+		seg = *seg_iter;
+
+		// Process the segment, gathering its input cells' states, to cache its activity for later.
+		seg->ProcessSegment(CellStates.Current);
+
+		// Now check for an active segment, we only need one for the cell to predict, but all Segments need to be checked
+		// so that a segment update will be created for each active segment, and so that the lowest numPredictionSteps 
+		// among active segments is adopted by the cell.
+		if (seg->GetIsActive())
+		{
+			cell = seg->GetParentCell();
+
+			if (cell->GetIsPredicting() == false) {
+				PredictingCells.push_back(cell);
+			}
+
+			cell->SetIsPredicting(true, seg->GetNumPredictionSteps());
+
+			if (seg->GetIsSequence())
 			{
-				seg->ProcessSegment();
+				cell->SetIsSegmentPredicting(true);
 			}
 
-			segments_iter.SetList(cell->Segments);
-			for (seg = (Segment*)(segments_iter.Reset()); seg != NULL; seg = (Segment*)(segments_iter.Advance()))
+			// a) reinforcement of the currently active segments
+			if (temporalLearning)
 			{
-				// Now check for an active segment, we only need one for the cell to predict, but all Segments need to be checked
-				// so that a segment update will be created for each active segment, and so that the lowest numPredictionSteps 
-				// among active segments is adopted by the cell.
-				if (seg->GetIsActive())
-				{
-					cell->SetIsPredicting(true, seg->GetNumPredictionSteps());
+				// Add segment update to this cell
+				cell->UpdateSegmentActiveSynapses(false, seg, false, UPDATE_DUE_TO_PREDICTIVE);
+			}
+		}
+	}
 
-					if (seg->GetIsSequence())
-					{
-						cell->SetIsSegmentPredicting(true);
-					}
+	// b) reinforcement of a segment that could have predicted 
+	//    this activation, i.e. a segment that has a (potentially weak)
+	//    match to activity during the previous time step (lines 50-53).
+	// NOTE: The check against MaxTimeSteps is a correctly functioning way of enforcing a maximum number of time steps, 
+	// as opposed to the previous way of storing Max(numPredictionSteps, MaxTimeSteps) as a segment's numPredictionSteps,
+	// which caused inaccurate numPredictionSteps values to be stored, resulting in duplicate segments being created.
+	// Note also that if the system of recording and using an exact number of time steps is abandonded (and replaced with the
+	// original sequence/non-sequence system), then all references to MaxTimeSteps can be removed.
+	// The predicting cells are visited in the order of their numbers, as they would be by a walk through every cell.
+	if (temporalLearning)
+	{
+		std::sort(PredictingCells.begin(), PredictingCells.end(), CompareCellNumbers);
 
-					// a) reinforcement of the currently active segments
-					if (temporalLearning)
-					{
-						// Add segment update to this cell
-						cell->UpdateSegmentActiveSynapses(false, seg, false, UPDATE_DUE_TO_PREDICTIVE);
-					}
-				}
+		for (std::vector<Cell*>::const_iterator cell_iter = PredictingCells.begin(), end = PredictingCells.end(); cell_iter != end; ++cell_iter)
+		{
+			cell = *cell_iter;
+
+			if (cell->GetNumPredictionSteps() == MaxTimeSteps) {
+				continue;
 			}
 
-			// b) reinforcement of a segment that could have predicted 
-			//    this activation, i.e. a segment that has a (potentially weak)
-			//    match to activity during the previous time step (lines 50-53).
-			// NOTE: The check against MaxTimeSteps is a correctly functioning way of enforcing a maximum number of time steps, 
-			// as opposed to the previous way of storing Max(numPredictionSteps, MaxTimeSteps) as a segment's numPredictionSteps,
-			// which caused inaccurate numPredictionSteps values to be stored, resulting in duplicate segments being created.
-			// Note also that if the system of recording and using an exact number of time steps is abandonded (and replaced with the
-			// original sequence/non-sequence system), then all references to MaxTimeSteps can be removed.
-			if (temporalLearning && cell->GetIsPredicting() && (cell->GetNumPredictionSteps() != MaxTimeSteps))
-			{
-				predictiveSegment = cell->GetBestMatchingPreviousSegment();
+			predictiveSegment = cell->GetBestMatchingPreviousSegment();
 
-				// Either update existing or add new segment for this cell considering
-				// only segments matching the number of prediction steps of the
-				// best currently active segment for this cell.
-				predictiveSegUpdate = cell->UpdateSegmentActiveSynapses(true, predictiveSegment, true, UPDATE_DUE_TO_PREDICTIVE);
-				if (predictiveSegment == NULL)
-				{
-					predictiveSegUpdate->NumPredictionSteps = cell->GetNumPredictionSteps() + 1;
-				}
+			// Either update existing or add new segment for this cell considering
+			// only segments matching the number of prediction steps of the
+			// best currently active segment for this cell.
+			predictiveSegUpdate = cell->UpdateSegmentActiveSynapses(true, predictiveSegment, true, UPDATE_DUE_TO_PREDICTIVE);
+			if (predictiveSegment == NULL)
+			{
+				predictiveSegUpdate->NumPredictionSteps = cell->GetNumPredictionSteps() + 1;
 			}
 		}
 	}
 
+	phaseStartTicks = Profiler.EndPhase(STEP_PHASE_TP_PREDICTIVE_STATE, phaseStartTicks);
+
 	// Phase3
 	// 54. for c, i in cells
 	// 55.   if learnState(c, i, t) == 1 then
@@ -600,6 +804,245 @@ void Region::PerformTemporalPooling()
 			}
 		}
 	}
+
+	Profiler.EndPhase(STEP_PHASE_TP_SEGMENT_UPDATES, phaseStartTicks);
+}
+
+/// Take into account an active segment, with the given number of active connected synapses, in the choice that
+/// Cell::GetPreviousActiveSegment() will make among its cell's segments during the next time step. Sequence
+/// segments are preferred, then those with the most active synapses, in the same way.
+static inline void ChoosePreviousActiveSegment(int _activeCount, bool _isSequence, int &_mostSyns, bool &_foundSequence, bool &_chosenIsSequence)
+{
+	if (_isSequence)
+	{
+		_foundSequence = true;
+		if (_activeCount > _mostSyns)
+		{
+			_mostSyns = _activeCount;
+			_chosenIsSequence = true;
+		}
+	}
+	else if ((!_foundSequence) && (_activeCount > _mostSyns))
+	{
+		_mostSyns = _activeCount;
+		_chosenIsSequence = false;
+	}
+}
+
+/// Freeze this Region for inference only, once its learning is finished. Its connected distal synapses 
+/// are compiled into read-only tables, and its proximal input indices rebuilt with only the synapses that
+/// contribute to overlap. While frozen, Step() performs no learning, boosting or duty cycle updates, and
+/// determines cell states from the tables alone; only the Cells' own states are kept up to date.
+void Region::Freeze()
+{
+	Column *col;
+	Cell *cell;
+	Segment *seg;
+	FastListIter segments_iter;
+	int cellNumber, mostSyns;
+	float prevReceptiveFieldSize;
+	bool foundSequence, chosenIsSequence;
+
+	if (Frozen) {
+		return;
+	}
+
+	int numCells = Width * Height * CellsPerCol;
+
+	FrozenCellSegments.assign(numCells + 1, 0);
+	FrozenSegmentSynapses.assign(1, 0);
+	FrozenSynapseCells.clear();
+	FrozenSegmentThresholds.clear();
+	FrozenSegmentPredictionSteps.clear();
+	FrozenSegmentIsSequence.clear();
+	FrozenCellActive.assign(numCells, 0);
+	FrozenCellSequencePredicted.assign(numCells, 0);
+
+	for (int ColIndex = 0; ColIndex < Width * Height; ColIndex++)
+	{
+		col = Columns[ColIndex];
+
+		// Apply any spatial learning accumulated during an unfinished SpatialLearningWindow, so that it isn't lost.
+		if (col->ProximalActiveCounts != NULL) 
+		{
+			prevReceptiveFieldSize = col->GetReceptiveFieldSize();
+			col->ApplyAccumulatedLearning();
+			ReceptiveFieldSizeSum += col->GetReceptiveFieldSize() - prevReceptiveFieldSize;
+		}
+
+		for (int cellIndex = 0; cellIndex < CellsPerCol; cellIndex++)
+		{
+			cell = col->Cells[cellIndex];
+			cellNumber = (ColIndex * CellsPerCol) + cellIndex;
+			mostSyns = 0;
+			foundSequence = false;
+			chosenIsSequence = false;
+
+			// Record each of the cell's segments, with its connected synapses.
+			segments_iter.SetList(cell->Segments);
+			for (seg = (Segment*)(segments_iter.Reset()); seg != NULL; seg = (Segment*)(segments_iter.Advance()))
+			{
+				for (int synIndex = 0; synIndex < (int)seg->SynapseCells.size(); synIndex++)
+				{
+					if (seg->SynapseConnected[synIndex]) {
+						FrozenSynapseCells.push_back(seg->SynapseCells[synIndex]);
+					}
+				}
+
+				FrozenSegmentSynapses.push_back((int)FrozenSynapseCells.size());
+				FrozenSegmentThresholds.push_back((int)ceil(seg->GetActiveThreshold()));
+				FrozenSegmentPredictionSteps.push_back(seg->GetNumPredictionSteps());
+				FrozenSegmentIsSequence.push_back(seg->GetIsSequence() ? 1 : 0);
+
+				// The segments' current activity determines which will be chosen during the first frozen time step.
+				if (seg->GetIsActive()) {
+					ChoosePreviousActiveSegment(seg->GetActiveConnectedSynapseCount(), seg->GetIsSequence(), mostSyns, foundSequence, chosenIsSequence);
+				}
+			}
+
+			FrozenCellSegments[cellNumber + 1] = (int)FrozenSegmentThresholds.size();
+			FrozenCellSequencePredicted[cellNumber] = chosenIsSequence ? 1 : 0;
+		}
+	}
+
+	Frozen = true;
+
+	// Rebuild the proximal input indices with only the synapses that contribute to overlap.
+	InitializeProximalInputIndices();
+}
+
+/// Return this Region to normal operation, discarding the frozen tables and bringing its distal 
+/// segments' states up to date with its cells.
+void Region::Unfreeze()
+{
+	FastListIter segments_iter;
+	Cell *cell;
+
+	if (Frozen == false) {
+		return;
+	}
+
+	Frozen = false;
+
+	std::vector<int>().swap(FrozenCellSegments);
+	std::vector<int>().swap(FrozenSegmentSynapses);
+	std::vector<int>().swap(FrozenSynapseCells);
+	std::vector<int>().swap(FrozenSegmentThresholds);
+	std::vector<int>().swap(FrozenSegmentPredictionSteps);
+	std::vector<unsigned char>().swap(FrozenSegmentIsSequence);
+	std::vector<unsigned char>().swap(FrozenCellActive);
+	std::vector<unsigned char>().swap(FrozenCellSequencePredicted);
+
+	// The segments weren't processed while frozen. Process them now, as they would have been during the last
+	// time step, so that the next time step finds their previous activity.
+	for (int ColIndex = 0; ColIndex < Width * Height; ColIndex++)
+	{
+		for (int cellIndex = 0; cellIndex < CellsPerCol; cellIndex++)
+		{
+			cell = Columns[ColIndex]->Cells[cellIndex];
+
+			segments_iter.SetList(cell->Segments);
+			for (Segment *seg = (Segment*)(segments_iter.Reset()); seg != NULL; seg = (Segment*)(segments_iter.Advance())) {
+				seg->ProcessSegment(CellStates.Current);
+			}
+		}
+	}
+
+	InitializeProximalInputIndices();
+}
+
+/// Performs temporal pooling for a frozen Region, from the frozen tables, without learning. This follows
+/// PerformTemporalPooling(), with each phase shared among the Region's workers.
+void Region::PerformFrozenTemporalPooling()
+{
+	long long phaseStartTicks = GetTimerTicks();
+
+	// Phase 1: Compute cell active states
+	RunSpatialPoolingWorkers(FrozenActiveStateWorker);
+
+	phaseStartTicks = Profiler.EndPhase(STEP_PHASE_TP_ACTIVE_STATE, phaseStartTicks);
+
+	// Phase 2: Compute cell predictive states, and give each cell its new state. Every cell's state is set.
+	RunSpatialPoolingWorkers(FrozenPredictiveStateWorker);
+	CellStates.TouchAll();
+
+	Profiler.EndPhase(STEP_PHASE_TP_PREDICTIVE_STATE, phaseStartTicks);
+}
+
+void Region::FrozenActiveStateWorker(void *_region, int _workerIndex, int _numWorkers)
+{
+	Region *region = (Region*)_region;
+	int beginColIndex, endColIndex, cellsPerCol = region->CellsPerCol;
+	unsigned char *cellActive, predicted;
+
+	WorkerPool::DetermineShare(region->Width * region->Height, _workerIndex, _numWorkers, beginColIndex, endColIndex);
+	for (int ColIndex = beginColIndex; ColIndex < endColIndex; ColIndex++)
+	{
+		cellActive = &(region->FrozenCellActive[ColIndex * cellsPerCol]);
+
+		if (region->Columns[ColIndex]->IsActive == false)
+		{
+			memset(cellActive, 0, cellsPerCol);
+			continue;
+		}
+
+		// The cells that were predicted by a sequence segment become active. If there are none, every cell becomes active.
+		predicted = 0;
+		for (int cellIndex = 0; cellIndex < cellsPerCol; cellIndex++)
+		{
+			cellActive[cellIndex] = region->FrozenCellSequencePredicted[(ColIndex * cellsPerCol) + cellIndex];
+			predicted |= cellActive[cellIndex];
+		}
+
+		if (predicted == 0) {
+			memset(cellActive, 1, cellsPerCol);
+		}
+	}
+}
+
+void Region::FrozenPredictiveStateWorker(void *_region, int _workerIndex, int _numWorkers)
+{
+	Region *region = (Region*)_region;
+	int beginColIndex, endColIndex, cellNumber, activeCount, numPredictionSteps, mostSyns;
+	bool predicting, segmentPredicting, foundSequence, chosenIsSequence;
+	const unsigned char *cellActive = &(region->FrozenCellActive[0]);
+	const int *synapseCells = region->FrozenSynapseCells.empty() ? NULL : &(region->FrozenSynapseCells[0]);
+
+	WorkerPool::DetermineShare(region->Width * region->Height, _workerIndex, _numWorkers, beginColIndex, endColIndex);
+	for (cellNumber = beginColIndex * region->CellsPerCol; cellNumber < endColIndex * region->CellsPerCol; cellNumber++)
+	{
+		predicting = false;
+		segmentPredicting = false;
+		numPredictionSteps = 0;
+		mostSyns = 0;
+		foundSequence = false;
+		chosenIsSequence = false;
+
+		for (int segIndex = region->FrozenCellSegments[cellNumber]; segIndex < region->FrozenCellSegments[cellNumber + 1]; segIndex++)
+		{
+			// Count the segment's connected synapses from active cells.
+			activeCount = 0;
+			for (int synIndex = region->FrozenSegmentSynapses[segIndex]; synIndex < region->FrozenSegmentSynapses[segIndex + 1]; synIndex++) {
+				activeCount += cellActive[synapseCells[synIndex]];
+			}
+
+			if (activeCount >= region->FrozenSegmentThresholds[segIndex])
+			{
+				// The cell adopts the lowest number of prediction steps among its active segments.
+				numPredictionSteps = predicting ? Min(numPredictionSteps, region->FrozenSegmentPredictionSteps[segIndex]) : region->FrozenSegmentPredictionSteps[segIndex];
+				predicting = true;
+
+				if (region->FrozenSegmentIsSequence[segIndex]) {
+					segmentPredicting = true;
+				}
+
+				ChoosePreviousActiveSegment(activeCount, region->FrozenSegmentIsSequence[segIndex] != 0, mostSyns, foundSequence, chosenIsSequence);
+			}
+		}
+
+		region->FrozenCellSequencePredicted[cellNumber] = chosenIsSequence ? 1 : 0;
+		region->Columns[cellNumber / region->CellsPerCol]->Cells[cellNumber % region->CellsPerCol]->SetFrozenState(cellActive[cellNumber] != 0, predicting, segmentPredicting, numPredictionSteps);
+	}
 }
 
 /// Get a reference to the Column at the specified column grid coordinate.
@@ -612,6 +1055,55 @@ Column *Region::GetColumn(int x, int y)
 	return Columns[(y * Width) + x];
 }
 
+/// Add to the given list the cells within the given area of columns that were learning during the previous time step, 
+/// in order of column X and then Y, skipping the cells whose numbers (see Cell::GetNumber()) are set in _excludedCells.
+///
+/// The index of the previous time step's learning cells is built the first time this is called in a time step. Because
+/// the columns are indexed by X and then Y, the learning cells of each column of the area are a single range of the index.
+void Region::GetPrevLearningCells(const Area &_area, const BitArray &_excludedCells, std::vector<Cell*> &_result)
+{
+	int x, y, i, colIndex, firstIndex, lastIndex;
+	Column *col;
+
+	if (PrevLearningCellsEpoch != Epoch)
+	{
+		PrevLearningCells.clear();
+
+		for (x = 0; x < Width; x++)
+		{
+			for (y = 0; y < Height; y++)
+			{
+				col = Columns[(y * Width) + x];
+				colIndex = col->Index * CellsPerCol;
+				PrevLearningCellsStart[(x * Height) + y] = (int)PrevLearningCells.size();
+
+				for (i = 0; i < CellsPerCol; i++)
+				{
+					if (CellStates.Previous[colIndex + i] & CELL_STATE_LEARNING) {
+						PrevLearningCells.push_back(col->Cells[i]);
+					}
+				}
+			}
+		}
+
+		PrevLearningCellsStart[Width * Height] = (int)PrevLearningCells.size();
+		PrevLearningCellsEpoch = Epoch;
+	}
+
+	for (x = _area.MinX; x <= _area.MaxX; x++)
+	{
+		firstIndex = PrevLearningCellsStart[(x * Height) + _area.MinY];
+		lastIndex = PrevLearningCellsStart[(x * Height) + _area.MaxY + 1];
+
+		for (i = firstIndex; i < lastIndex; i++)
+		{
+			if (!_excludedCells.Get(PrevLearningCells[i]->GetNumber())) {
+				_result.push_back(PrevLearningCells[i]);
+			}
+		}
+	}
+}
+
 /// The radius of the average connected receptive field size of all the columns. 
 /// 
 /// returns: The average connected receptive field size (in hypercolumn grid space).
@@ -621,36 +1113,297 @@ Column *Region::GetColumn(int x, int y)
 /// determine the extent of lateral inhibition between columns.
 float Region::AverageReceptiveFieldSize()
 {
-	float maxDistance, sum = 0.0;
-	Column *col;
-	FastListIter synapses_iter;
+	return (float)(ReceptiveFieldSizeSum / (double)(Width * Height));
+}
+
+/// Rebuild each Column's arrays of proximal synapse state, and its record of its connected 
+/// proximal synapses. Called after the proximal synapses have been created or loaded.
+void Region::InitializeReceptiveFields()
+{
+	ReceptiveFieldSizeSum = 0.0;
 
 	for (int ColIndex = 0; ColIndex < Width * Height; ColIndex++)
 	{
-		col = Columns[ColIndex];
+		Columns[ColIndex]->InitializeProximalSynapses();
+		Columns[ColIndex]->InitializeReceptiveField();
+		ReceptiveFieldSizeSum += Columns[ColIndex]->GetReceptiveFieldSize();
+	}
+}
+
+/// Rebuild the index from each input value to the proximal synapses that sample it, for each
+/// spatial pooling worker. Called after InitializeReceptiveFields().
+void Region::InitializeProximalInputIndices()
+{
+	int workerIndex, inputIndex, beginColIndex, endColIndex;
+
+	// Create an index for each worker and input DataSpace, if they don't yet exist.
+	if (ProximalInputIndices.size() != (NumThreads * InputList.size()))
+	{
+		for (std::vector<ProximalInputIndex*>::const_iterator index_iter = ProximalInputIndices.begin(), end = ProximalInputIndices.end(); index_iter != end; ++index_iter) {
+			delete (*index_iter);
+		}
 
-		// Initialize maxIstance to 0.
-		maxDistance = 0.0f;
+		ProximalInputIndices.clear();
 
-		// Iterate through each of the current column's proximal synapses...
-		synapses_iter.SetList(col->ProximalSegment->Synapses);
-		for (Synapse *syn = (Synapse*)(synapses_iter.Reset()); syn != NULL; syn = (Synapse*)(synapses_iter.Advance()))
+		for (workerIndex = 0; workerIndex < NumThreads; workerIndex++) 
 		{
-			// Skip non-connected synapses.
-			if (syn->GetIsConnected() == false) {
-				continue;
+			for (inputIndex = 0; inputIndex < (int)InputList.size(); inputIndex++) {
+				ProximalInputIndices.push_back(new ProximalInputIndex(InputList[inputIndex]));
 			}
+		}
+	}
+
+	// Build each worker's indices from the synapses of its share of the Columns.
+	for (workerIndex = 0; workerIndex < NumThreads; workerIndex++) 
+	{
+		WorkerPool::DetermineShare(Width * Height, workerIndex, NumThreads, beginColIndex, endColIndex);
+
+		for (inputIndex = 0; inputIndex < (int)InputList.size(); inputIndex++) {
+			ProximalInputIndices[(workerIndex * InputList.size()) + inputIndex]->Build(Columns + beginColIndex, endColIndex - beginColIndex, Frozen);
+		}
+	}
+}
+
+/// Copy each Column's proximal synapse permanences into its ProximalSynapse objects. Called 
+/// between time steps, before the ProximalSynapse objects are saved or displayed.
+void Region::StoreProximalPermanences()
+{
+	for (int ColIndex = 0; ColIndex < Width * Height; ColIndex++) {
+		Columns[ColIndex]->StoreProximalPermanences();
+	}
+}
+
+/// Determine the number of active connected, and active well connected, proximal synapses of the 
+/// given worker's share of the Columns, by visiting only the synapses that sample currently active
+/// input values. The activity of each input must already have been determined for this time step.
+void Region::AccumulateProximalActivity(int _workerIndex)
+{
+	int beginColIndex, endColIndex;
+
+	WorkerPool::DetermineShare(Width * Height, _workerIndex, NumThreads, beginColIndex, endColIndex);
+
+	for (int ColIndex = beginColIndex; ColIndex < endColIndex; ColIndex++)
+	{
+		Columns[ColIndex]->ActiveConnectedSynapsesCount = 0;
+		Columns[ColIndex]->ActiveWellConnectedSynapsesCount = 0;
+	}
+
+	for (int inputIndex = 0; inputIndex < (int)InputList.size(); inputIndex++) {
+		ProximalInputIndices[(_workerIndex * InputList.size()) + inputIndex]->AccumulateActiveSynapses();
+	}
+}
+
+/// Set the number of threads that perform this Region's spatial pooling.
+void Region::SetNumThreads(int _numThreads)
+{
+	_ASSERT(_numThreads >= 1);
+
+	if (_numThreads == NumThreads) {
+		return;
+	}
+
+	NumThreads = _numThreads;
+
+	// Replace the pool of workers. The calling thread is always one of the workers, so no pool is needed for one thread.
+	delete SpatialPoolingWorkers;
+	SpatialPoolingWorkers = (NumThreads > 1) ? new WorkerPool(NumThreads) : NULL;
+
+	InhibitionOverlaps.resize(NumThreads);
+	ReceptiveFieldSizeDeltas.resize(NumThreads, 0.0);
+
+	// If the proximal input indices have already been built, rebuild them for the new shares of the Columns.
+	if (ProximalInputIndices.size() > 0) {
+		InitializeProximalInputIndices();
+	}
+}
+
+/// Have each spatial pooling worker run the given function, with this Region as its data, and wait for
+/// them all to finish.
+void Region::RunSpatialPoolingWorkers(WorkerFunction _function)
+{
+	if (SpatialPoolingWorkers == NULL) {
+		_function(this, 0, 1);
+	} else {
+		SpatialPoolingWorkers->Run(_function, this);
+	}
+}
+
+void Region::ComputeOverlapWorker(void *_region, int _workerIndex, int _numWorkers)
+{
+	Region *region = (Region*)_region;
+	int beginColIndex, endColIndex;
+
+	region->AccumulateProximalActivity(_workerIndex);
+
+	WorkerPool::DetermineShare(region->Width * region->Height, _workerIndex, _numWorkers, beginColIndex, endColIndex);
+	for (int ColIndex = beginColIndex; ColIndex < endColIndex; ColIndex++) {
+		region->Columns[ColIndex]->ComputeOverlap();
+	}
+}
+
+void Region::ComputeInhibitionThresholdsWorker(void *_region, int _workerIndex, int _numWorkers)
+{
+	Region *region = (Region*)_region;
+	int beginIndex, endIndex;
+
+	WorkerPool::DetermineShare(region->HypercolumnsX * region->HypercolumnsY, _workerIndex, _numWorkers, beginIndex, endIndex);
+	region->ComputeInhibitionThresholds(beginIndex, endIndex, region->InhibitionOverlaps[_workerIndex]);
+}
+
+void Region::ComputeColumnInhibitionWorker(void *_region, int _workerIndex, int _numWorkers)
+{
+	Region *region = (Region*)_region;
+	int beginColIndex, endColIndex;
+
+	WorkerPool::DetermineShare(region->Width * region->Height, _workerIndex, _numWorkers, beginColIndex, endColIndex);
+	for (int ColIndex = beginColIndex; ColIndex < endColIndex; ColIndex++) {
+		region->Columns[ColIndex]->ComputeColumnInhibition();
+	}
+}
+
+void Region::SpatialLearningWorker(void *_region, int _workerIndex, int _numWorkers)
+{
+	Region *region = (Region*)_region;
+	Column *col;
+	int beginColIndex, endColIndex;
+	float prevReceptiveFieldSize;
+	double receptiveFieldSizeDelta = 0.0;
+
+	WorkerPool::DetermineShare(region->Width * region->Height, _workerIndex, _numWorkers, beginColIndex, endColIndex);
+	if (region->SpatialLearningAllowed)
+	{
+		for (int ColIndex = beginColIndex; ColIndex < endColIndex; ColIndex++)
+		{
+			col = region->Columns[ColIndex];
+		
+			if (col->GetIsActive())
+			{
+				if (region->SpatialLearningWindow > 1) 
+				{
+					col->AccumulateLearning();
+				} 
+				else 
+				{
+					prevReceptiveFieldSize = col->GetReceptiveFieldSize();
+					col->AdaptPermanences();
+					receptiveFieldSizeDelta += col->GetReceptiveFieldSize() - prevReceptiveFieldSize;
+				}
+			}
+		}
+	}
+
+	// At the end of each SpatialLearningWindow, apply the learning accumulated over it. This is done even if
+	// learning is no longer allowed, so that the last window's learning is not lost.
+	if ((region->SpatialLearningWindow > 1) && ((region->GetStepCounter() % region->SpatialLearningWindow) == 0))
+	{
+		for (int ColIndex = beginColIndex; ColIndex < endColIndex; ColIndex++) 
+		{
+			col = region->Columns[ColIndex];
+			prevReceptiveFieldSize = col->GetReceptiveFieldSize();
+			col->ApplyAccumulatedLearning();
+			receptiveFieldSizeDelta += col->GetReceptiveFieldSize() - prevReceptiveFieldSize;
+		}
+	}
+
+	region->UpdateDutyCycles(beginColIndex, endColIndex);
+
+	// Record each Column's maximum neighborhood duty cycle, and perform boosting. If duty cycles are updated 
+	// lazily, the maximum is only determined while boosting is allowed.
+	if (region->BoostingAllowed || !region->LazyDutyCycles)
+	{
+		for (int ColIndex = beginColIndex; ColIndex < endColIndex; ColIndex++)
+		{
+			col = region->Columns[ColIndex];
+
+			col->maxDutyCycle = col->DetermineMaxDutyCycle();
+
+			if (region->BoostingAllowed) 
+			{
+				prevReceptiveFieldSize = col->GetReceptiveFieldSize();
+				col->PerformBoosting();
+				receptiveFieldSizeDelta += col->GetReceptiveFieldSize() - prevReceptiveFieldSize;
+			}
+		}
+	}
+
+	// Record the change in this worker's Columns' receptive field sizes, to be added to the Region's sum.
+	region->ReceptiveFieldSizeDeltas[_workerIndex] = receptiveFieldSizeDelta;
+}
+
+void Region::UpdateDutyCycles(int _begin, int _end)
+{
+	Column *col;
+	int colIndex, steps;
+	float active, overlapped;
+
+	if (LazyDutyCycles)
+	{
+		// Only update the duty cycles of Columns that are active or have overlap, unless boosting (which reads 
+		// every Column's duty cycles) is allowed. The decay over the time steps since each Column's last update 
+		// is applied at once.
+		for (colIndex = _begin; colIndex < _end; colIndex++)
+		{
+			col = Columns[colIndex];
+			active = col->GetIsActive() ? 1.0f : 0.0f;
+			overlapped = col->HasMinOverlap() ? 1.0f : 0.0f;
 
-			// Determine the distance of the further proximal synapse. This will be considered the size of the receptive field.
-			maxDistance = Max(maxDistance, ((ProximalSynapse*)syn)->DistanceToInput);
+			if (BoostingAllowed || (active != 0.0f) || (overlapped != 0.0f))
+			{
+				steps = DutyCycleTime - DutyCycleTimes[colIndex];
+				ActiveDutyCycles[colIndex] = DecayMovingAverage(ActiveDutyCycles[colIndex], EmaAlpha, steps) + (EmaAlpha * active);
+				FastActiveDutyCycles[colIndex] = DecayMovingAverage(FastActiveDutyCycles[colIndex], FastEmaAlpha, steps) + (FastEmaAlpha * active);
+				OverlapDutyCycles[colIndex] = DecayMovingAverage(OverlapDutyCycles[colIndex], EmaAlpha, steps) + (EmaAlpha * overlapped);
+				DutyCycleTimes[colIndex] = DutyCycleTime;
+			}
 		}
 
-		// Add the current column's receptive field size to the sum.
-		sum += maxDistance;
+		return;
 	}
 
-	// Return this Region's average receptive field size.
-	return (sum / (float)(Width * Height));
+	// Gather whether each Column was active, and whether its overlap reached its MinOverlap.
+	for (colIndex = _begin; colIndex < _end; colIndex++)
+	{
+		col = Columns[colIndex];
+		ActiveDutyCycleInputs[colIndex] = col->GetIsActive() ? 1.0f : 0.0f;
+		OverlapDutyCycleInputs[colIndex] = col->HasMinOverlap() ? 1.0f : 0.0f;
+	}
+
+	// Update every Column's duty cycles in a single pass over contiguous arrays, without branches, so that 
+	// the compiler may vectorize it.
+	float *activeDutyCycles = &ActiveDutyCycles[0], *fastActiveDutyCycles = &FastActiveDutyCycles[0], *overlapDutyCycles = &OverlapDutyCycles[0];
+	const float *activeInputs = &ActiveDutyCycleInputs[0], *overlapInputs = &OverlapDutyCycleInputs[0];
+	for (colIndex = _begin; colIndex < _end; colIndex++)
+	{
+		activeDutyCycles[colIndex] = ((1.0f - EmaAlpha) * activeDutyCycles[colIndex]) + (EmaAlpha * activeInputs[colIndex]);
+		fastActiveDutyCycles[colIndex] = ((1.0f - FastEmaAlpha) * fastActiveDutyCycles[colIndex]) + (FastEmaAlpha * activeInputs[colIndex]);
+		overlapDutyCycles[colIndex] = ((1.0f - EmaAlpha) * overlapDutyCycles[colIndex]) + (EmaAlpha * overlapInputs[colIndex]);
+	}
+}
+
+void Region::SetDutyCycles(int _colIndex, float _overlapDutyCycle, float _activeDutyCycle, float _fastActiveDutyCycle)
+{
+	OverlapDutyCycles[_colIndex] = _overlapDutyCycle;
+	ActiveDutyCycles[_colIndex] = _activeDutyCycle;
+	FastActiveDutyCycles[_colIndex] = _fastActiveDutyCycle;
+	DutyCycleTimes[_colIndex] = DutyCycleTime;
+}
+
+/// Determine the DesiredLocalActivity of each Column, if the radius in hypercolumns of the
+/// inhibition area has changed since it was last determined (or if _force is true).
+void Region::UpdateDesiredLocalActivity(bool _force)
+{
+	// The radius, in hypercolumns, used by DetermineColumnsWithinHypercolumnRadius().
+	int radius = (int)(InhibitionRadius + 0.5f);
+
+	if ((radius == DesiredLocalActivityRadius) && !_force) {
+		return;
+	}
+
+	DesiredLocalActivityRadius = radius;
+
+	for (int ColIndex = 0; ColIndex < Width * Height; ColIndex++) {
+		Columns[ColIndex]->DetermineDesiredLocalActivity();
+	}
 }
 
 /// Return true if the given Column has an overlap value that is at least the
@@ -658,57 +1411,197 @@ float Region::AverageReceptiveFieldSize()
 ///
 /// This function is effectively determining which columns are to be inhibited 
 /// during the spatial pooling procedure of the region.
-bool Region::IsWithinKthScore(Column *col, int k)
+bool Region::IsWithinKthScore(Column *col)
+{
+	// Fewer than k neighbor columns have strictly greater overlap than the given column exactly
+	// when its overlap is at least the k'th largest, which has already been found for its hypercolumn.
+	return col->GetOverlap() >= InhibitionThresholds[(col->HypercolumnPosition.Y * HypercolumnsX) + col->HypercolumnPosition.X];
+}
+
+/// For each hypercolumn, determine the k'th largest overlap amongst all columns within
+/// inhibitionRadius hypercolumns of it, where k is the DesiredLocalActivity of its columns.
+/// 
+/// Every column of a hypercolumn has the same inhibition area and DesiredLocalActivity, so
+/// this is done once per hypercolumn rather than once per column. Only the hypercolumns with
+/// indices from _begin up to (but not including) _end are considered, using the given buffer.
+void Region::ComputeInhibitionThresholds(int _begin, int _end, std::vector<float> &_overlaps)
+{
+	Column *col;
+	int hx, hy;
+
+	for (int i = _begin; i < _end; i++)
+	{
+		hy = i / HypercolumnsX;
+		hx = i % HypercolumnsX;
+
+		// Use the hypercolumn's first column to determine the inhibition area and k shared by all of its columns.
+		col = Columns[((hy * HypercolumnDiameter) * Width) + (hx * HypercolumnDiameter)];
+		Area inhibitionArea = col->DetermineColumnsWithinHypercolumnRadius(InhibitionRadius + 0.5f);
+
+		InhibitionThresholds[i] = DetermineKthLargestOverlap(inhibitionArea, col->DesiredLocalActivity, _overlaps);
+	}
+}
+
+/// Returns true if every hypercolumn's inhibition area covers the whole Region, in which case
+/// inhibition is global and a single threshold applies to every column.
+bool Region::IsInhibitionGlobal()
 {
-	// Determine the extent, in columns, of the area within the InhibitionRadius hypercolumns of the given col's hypercolumn.
-	Area inhibitionArea = col->DetermineColumnsWithinHypercolumnRadius(InhibitionRadius + 0.5f);
+	// The radius, in hypercolumns, used by DetermineColumnsWithinHypercolumnRadius().
+	int radius = (int)(InhibitionRadius + 0.5f);
+
+	// Even the hypercolumns in the corners must reach the opposite edges.
+	return (radius >= (HypercolumnsX - 1)) && (radius >= (HypercolumnsY - 1));
+}
+
+/// Determine the single inhibition threshold used when inhibition is global, with one
+/// selection pass over the overlaps of every column in the Region.
+void Region::ComputeGlobalInhibitionThreshold()
+{
+	// Every column's inhibition area is the whole Region, so every column has the same DesiredLocalActivity.
+	Area regionArea(0, 0, Width - 1, Height - 1);
+	float threshold = DetermineKthLargestOverlap(regionArea, Columns[0]->DesiredLocalActivity, InhibitionOverlaps[0]);
+
+	for (int i = 0; i < HypercolumnsX * HypercolumnsY; i++) {
+		InhibitionThresholds[i] = threshold;
+	}
+}
 
-	//Loop over all columns that are within inhibitionRadius hypercolumns of the given column's hypercolumn.
-	// Count how many neighbor columns have strictly greater overlap than our
-	// given column. If this count is <k then we are within the kth score
-	int numberColumns = 0;
-	for (int x = inhibitionArea.MinX; x <= inhibitionArea.MaxX; x++)
+/// Find the maximum of the _count values starting at _src and separated by _stride, within _radius
+/// positions to either side of each position (clipped at the ends). The results are written to
+/// _dst using the same stride. Each position is added to and removed from the queue at most once.
+static void SlidingWindowMax(const float *_src, float *_dst, int _count, int _stride, int _radius, int *_queue)
+{
+	// The queue holds positions in order, with decreasing values; the front is the window's maximum.
+	int head = 0, tail = 0, next = 0;
+
+	for (int i = 0; i < _count; i++)
 	{
-		for (int y = inhibitionArea.MinY; y <= inhibitionArea.MaxY; y++)
+		// Add the positions up to the right edge of this position's window.
+		for (; (next < _count) && (next <= i + _radius); next++)
 		{
-			numberColumns += (Columns[(y * Width) + x]->GetOverlap() > col->GetOverlap()) ? 1 : 0;
+			// Values that are no larger than the new value can never again be the maximum.
+			while ((tail > head) && (_src[_queue[tail - 1] * _stride] <= _src[next * _stride])) {
+				tail--;
+			}
+
+			_queue[tail++] = next;
 		}
+
+		// Remove the position that has passed the left edge of the window.
+		if (_queue[head] < i - _radius) {
+			head++;
+		}
+
+		_dst[i * _stride] = _src[_queue[head] * _stride];
 	}
-	return numberColumns < k; //if count is < k, we are within the kth score of all neighbors
 }
 
-/// Run one time step iteration for this Region.
+/// For each hypercolumn, determine the maximum ActiveDutyCycle of the columns within
+/// inhibitionRadius hypercolumns of it.
 ///
-/// All cells will have their current (last run) state pushed back to be their 
-/// new previous state and their new current state reset to no activity.  
-/// Then SpatialPooling followed by TemporalPooling is performed for one time step.
-void Region::Step()
+/// The maximum within each hypercolumn is found first. A sliding window maximum is then run
+/// along each row of hypercolumns and then along each column of the result, which together
+/// give the maximum over each square inhibition area in time proportional to the number of columns.
+void Region::ComputeMaxDutyCycles()
 {
-	Column *col;
-	Cell *cell;
+	int hx, hy, hcolIndex;
+	float dutyCycle;
 
-	for (int ColIndex = 0; ColIndex < Width * Height; ColIndex++)
+	// The radius, in hypercolumns, used by DetermineColumnsWithinHypercolumnRadius().
+	int radius = (int)(InhibitionRadius + 0.5f);
+
+	// Determine the maximum ActiveDutyCycle within each hypercolumn.
+	for (hcolIndex = 0; hcolIndex < HypercolumnsX * HypercolumnsY; hcolIndex++) {
+		HypercolumnMaxDutyCycles[hcolIndex] = 0.0f;
+	}
+
+	for (int y = 0; y < Height; y++)
 	{
-		col = Columns[ColIndex];
+		for (int x = 0; x < Width; x++)
+		{
+			hcolIndex = ((y / HypercolumnDiameter) * HypercolumnsX) + (x / HypercolumnDiameter);
+			dutyCycle = GetActiveDutyCycle((y * Width) + x);
+			HypercolumnMaxDutyCycles[hcolIndex] = Max(HypercolumnMaxDutyCycles[hcolIndex], dutyCycle);
+		}
+	}
 
-		col->ProximalSegment->NextTimeStep();
+	// Horizontal pass, along each row of hypercolumns.
+	for (hy = 0; hy < HypercolumnsY; hy++) {
+		SlidingWindowMax(&HypercolumnMaxDutyCycles[hy * HypercolumnsX], &RowMaxDutyCycles[hy * HypercolumnsX], HypercolumnsX, 1, radius, &MaxDutyCycleQueue[0]);
+	}
 
-		for (int cellIndex = 0; cellIndex < GetCellsPerCol(); cellIndex++)
+	// Vertical pass, along each column of the horizontal pass's results.
+	for (hx = 0; hx < HypercolumnsX; hx++) {
+		SlidingWindowMax(&RowMaxDutyCycles[hx], &NeighborhoodMaxDutyCycles[hx], HypercolumnsY, HypercolumnsX, radius, &MaxDutyCycleQueue[0]);
+	}
+}
+
+/// Returns the k'th largest overlap amongst the columns within the given area. Returns FLT_MAX
+/// if k is 0, so that no column is within the k'th score, and -FLT_MAX if k is larger than the
+/// area, so that every column is. The given buffer is used to gather the overlaps.
+float Region::DetermineKthLargestOverlap(Area &_area, int _k, std::vector<float> &_overlaps)
+{
+	if (_k <= 0) {
+		return FLT_MAX;
+	}
+
+	if (_k > _area.GetArea()) {
+		return -FLT_MAX;
+	}
+
+	// Gather the overlaps of all columns within the area.
+	_overlaps.clear();
+	for (int y = _area.MinY; y <= _area.MaxY; y++)
+	{
+		for (int x = _area.MinX; x <= _area.MaxX; x++)
 		{
-			cell = col->Cells[cellIndex];
-			cell->NextTimeStep();
+			_overlaps.push_back(Columns[(y * Width) + x]->GetOverlap());
 		}
 	}
 
+	// Partially sort the overlaps so that the k'th largest is in place. Columns whose overlap ties
+	// with it are all within the k'th score; the small differences between columns' Boost values
+	// keep such ties rare.
+	std::nth_element(_overlaps.begin(), _overlaps.begin() + (_k - 1), _overlaps.end(), std::greater<float>());
+
+	return _overlaps[_k - 1];
+}
+
+/// Run one time step iteration for this Region.
+///
+/// All cells will have their current (last run) state pushed back to be their 
+/// new previous state and their new current state reset to no activity.  
+/// Then SpatialPooling followed by TemporalPooling is performed for one time step.
+void Region::Step()
+{
+	long long phaseStartTicks = GetTimerTicks();
+
+	// Each cell's current state becomes its previous state, and only the cell states set two time steps ago are reset.
+	// Advancing the epoch puts every segment's state out of date, so each is advanced when it is next accessed.
+	CellStates.Advance();
+	Epoch++;
+
 	// Compute Region statistics
 	ComputeBasicStatistics();
 
+	Profiler.EndPhase(STEP_PHASE_NEXT_TIME_STEP, phaseStartTicks);
+
 	// Perform pooling
 	PerformSpatialPooling();
-	PerformTemporalPooling();
 
-	// Determine accuracy of patterns matched by proximal segments.
-	ComputeColumnAccuracy();
+	if (Frozen) {
+		PerformFrozenTemporalPooling();
+	} else {
+		PerformTemporalPooling();
+	}
+
+	// Take any samples of statistics that are due.
+	phaseStartTicks = GetTimerTicks();
+	ComputeStatistics();
+	Profiler.EndPhase(STEP_PHASE_STATISTICS, phaseStartTicks);
+
+	// Record this step's latencies.
+	Profiler.EndStep();
 }
 
 /// Statistics
@@ -717,6 +1610,14 @@ void Region::Step()
 void Region::InitializeStatisticParameters()
 {
 	StepCounter = 0;
+
+	// The duty cycles are measured in time steps, so are considered up to date as of the restarted count.
+	DutyCycleTime = 0;
+	std::fill(DutyCycleTimes.begin(), DutyCycleTimes.end(), 0);
+
+	for (std::vector<Statistic*>::const_iterator statistic_iter = Statistics.begin(), end = Statistics.end(); statistic_iter != end; ++statistic_iter) {
+		(*statistic_iter)->Reset();
+	}
 }
 
 /// Updates statistics values.
@@ -725,50 +1626,32 @@ void Region::ComputeBasicStatistics()
 	StepCounter++;
 }
 
-void Region::ComputeColumnAccuracy()
+/// Have each of this Region's Statistics take a sample and record a report, if due.
+void Region::ComputeStatistics()
 {
-	Column *col;
-	FastListIter segments_iter;
+	for (std::vector<Statistic*>::const_iterator statistic_iter = Statistics.begin(), end = Statistics.end(); statistic_iter != end; ++statistic_iter) {
+		(*statistic_iter)->Step(this);
+	}
+}
 
-	if ((GetStepCounter() % 1000) == 1)
+/// Returns this Region's Statistic with the given ID (compared without regard to case), or NULL if there is none.
+Statistic *Region::GetStatistic(const std::string &_id)
+{
+	for (std::vector<Statistic*>::const_iterator statistic_iter = Statistics.begin(), end = Statistics.end(); statistic_iter != end; ++statistic_iter)
 	{
-		if (GetStepCounter() > 1)
-		{
-			// Determine avergage missing and extra synapses over the past 1000 time steps.
-			float avgMissingSynapses = (float)fd_missingSynapesCount / (float)fd_numActiveCols;
-			float avgExtraSynapses = (float)fd_extraSynapsesCount / (float)fd_numActiveCols;
+		const std::string &id = (*statistic_iter)->GetID();
 
-			// Log results.
-			QString stepString, avgMissingSynapsesString, avgExtraSynapsesString;
-			stepString.setNum(GetStepCounter());
-			avgMissingSynapsesString.setNum(avgMissingSynapses);
-			avgExtraSynapsesString.setNum(avgExtraSynapses);
-			Manager->WriteToLog(QString("Time ") + stepString + QString(" feature accuracy: Missing synapses: ") + avgMissingSynapsesString + QString(", Extra synapses: ") + avgExtraSynapsesString + QString("."));
+		if (id.size() != _id.size()) {
+			continue;
 		}
 
-		fd_numActiveCols = 0;
-		fd_missingSynapesCount = 0;
-		fd_extraSynapsesCount = 0;
-	}
-
-	for (int ColIndex = 0; ColIndex < Width * Height; ColIndex++)
-	{
-		col = Columns[ColIndex];
-
-		if (col->GetIsActive())
-		{
-			fd_numActiveCols++;
+		size_t i;
+		for (i = 0; (i < id.size()) && (tolower(id[i]) == tolower(_id[i])); i++);
 
-			FastListIter synapses_iter(col->ProximalSegment->Synapses);
-			for (Synapse *syn = (Synapse*)(synapses_iter.Reset()); syn != NULL; syn = (Synapse*)(synapses_iter.Advance()))
-			{
-				if (syn->GetIsActive() && (syn->GetIsConnected() == false)) {
-					fd_missingSynapesCount++;
-				}
-				else if ((syn->GetIsActive() == false) && (syn->GetIsConnected())) {
-					fd_extraSynapsesCount++;
-				}
-			}
+		if (i == id.size()) {
+			return (*statistic_iter);
 		}
 	}
+
+	return NULL;
 }
\ No newline at end of file
@@ -1,9 +1,14 @@
 #pragma once
 #include "Column.h"
+#include "Cell.h"
 #include "InputSpace.h"
 #include "SegmentUpdateInfo.h"
 #include "DataSpace.h"
 #include "Synapse.h"
+#include "StepProfiler.h"
+#include "ProximalInputIndex.h"
+#include "WorkerPool.h"
+#include "Statistic.h"
 #include <list>
 
 class NetworkManager;
@@ -159,6 +164,113 @@ public:
 	// The diameter of a hypercolumn in this Region. Defaults to 1.
 	int HypercolumnDiameter;
 
+	// The number of hypercolumns across and down this Region's Column grid. Hypercolumns along the
+	// right and bottom edges may be partial, if the grid's size is not a multiple of HypercolumnDiameter.
+	int HypercolumnsX, HypercolumnsY;
+
+	// For each hypercolumn, the k'th largest overlap among the columns within InhibitionRadius
+	// hypercolumns of it, where k is its columns' DesiredLocalActivity. Computed once per time step
+	// by ComputeInhibitionThresholds(), and shared by all of the hypercolumn's columns.
+	float *InhibitionThresholds;
+
+	// The radius, in hypercolumns, for which each Column's DesiredLocalActivity was last determined.
+	int DesiredLocalActivityRadius;
+
+	// The number of threads that perform this Region's spatial pooling, each taking its own share of the
+	// Columns, and the pool of workers they belong to (NULL if there is only one thread). Defaults to 1.
+	int NumThreads;
+	WorkerPool *SpatialPoolingWorkers;
+
+	// Whether spatial learning and boosting are allowed during the current time step.
+	bool SpatialLearningAllowed, BoostingAllowed;
+
+	// For each spatial pooling worker, and each input DataSpace, the index from the input's values to the 
+	// proximal synapses of the worker's share of the Columns that sample them. The index for a given worker
+	// and input is at [(workerIndex * InputList.size()) + inputIndex].
+	std::vector<ProximalInputIndex*> ProximalInputIndices;
+
+	// Buffers used by ComputeInhibitionThresholds() to gather the overlaps within an inhibition area, one
+	// for each spatial pooling worker.
+	std::vector< std::vector<float> > InhibitionOverlaps;
+
+	// The sum of all Columns' receptive field sizes, kept up to date as their proximal synapses become connected or 
+	// disconnected, so that AverageReceptiveFieldSize() needn't visit every Column. During spatial learning, each 
+	// worker accumulates the change in its share of the Columns' sizes in its own slot of ReceptiveFieldSizeDeltas, 
+	// and these are added to the sum in order of worker index once all workers have finished.
+	double ReceptiveFieldSizeSum;
+	std::vector<double> ReceptiveFieldSizeDeltas;
+
+	// For each hypercolumn, the maximum ActiveDutyCycle among the columns within InhibitionRadius
+	// hypercolumns of it. Computed once per time step by ComputeMaxDutyCycles().
+	std::vector<float> NeighborhoodMaxDutyCycles;
+
+	// Buffers used by ComputeMaxDutyCycles(): the maximum ActiveDutyCycle within each hypercolumn,
+	// the result of the horizontal pass, and the queue of the sliding window.
+	std::vector<float> HypercolumnMaxDutyCycles, RowMaxDutyCycles;
+	std::vector<int> MaxDutyCycleQueue;
+
+	// The state of each of this Region's cells during the current and the previous time step. The Cells read and
+	// write their own states here, and distal segments gather their input cells' states from here (see 
+	// Segment::SynapseCells). Advanced at the start of each time step.
+	CellStateBuffers CellStates;
+
+	// The number of time steps this Region has been advanced through. Unlike StepCounter it is never restarted, 
+	// so that a distal segment can tell whether its state is out of date (see Segment::Refresh()).
+	int Epoch;
+
+	// Buffers used by PerformTemporalPooling(): the distal segments that have active synapses during the
+	// current time step, and the cells that are predicting.
+	std::vector<Segment*> TouchedSegments;
+	std::vector<Cell*> PredictingCells;
+
+	// An index of the cells that were learning during the previous time step, from which new distal synapses are formed
+	// (see SegmentUpdateInfo::Initialize()). It is built when first needed in each time step, by GetPrevLearningCells(). 
+	// The columns are ordered by X and then Y, and the learning cells of the column at (x, y) are PrevLearningCells 
+	// PrevLearningCellsStart[(x * Height) + y] to PrevLearningCellsStart[(x * Height) + y + 1] - 1. PrevLearningCellsEpoch 
+	// is the Epoch at which the index was built.
+	std::vector<Cell*> PrevLearningCells;
+	std::vector<int> PrevLearningCellsStart;
+	int PrevLearningCellsEpoch;
+
+	// True while this Region is frozen for inference only (see Freeze()).
+	bool Frozen;
+
+	// While this Region is frozen, its distal segments in a compact read-only form, keeping only their connected
+	// synapses. Cells are numbered (ColIndex * CellsPerCol) + cellIndex. The segments of cell c are numbered 
+	// FrozenCellSegments[c] to FrozenCellSegments[c + 1] - 1, and the synapses of segment s are FrozenSegmentSynapses[s]
+	// to FrozenSegmentSynapses[s + 1] - 1, with FrozenSynapseCells giving the number of the cell each synapse is from.
+	std::vector<int> FrozenCellSegments, FrozenSegmentSynapses, FrozenSynapseCells;
+
+	// Each frozen segment's activation threshold and number of prediction steps, and whether it is a sequence segment.
+	std::vector<int> FrozenSegmentThresholds, FrozenSegmentPredictionSteps;
+	std::vector<unsigned char> FrozenSegmentIsSequence;
+
+	// Whether each cell is active during the current time step, and whether the segment that 
+	// Cell::GetPreviousActiveSegment() would choose for it during the next time step is a sequence segment.
+	std::vector<unsigned char> FrozenCellActive, FrozenCellSequencePredicted;
+
+	// Each Column's moving averages of how often it has been active (at the normal and the fast rate), and
+	// of how often its overlap has reached its MinOverlap, in the order of Columns.
+	std::vector<float> ActiveDutyCycles, FastActiveDutyCycles, OverlapDutyCycles;
+
+	// Whether each Column was active, and whether its overlap reached its MinOverlap, during the current
+	// time step (1 or 0), gathered so that the duty cycles can then be updated in one pass.
+	std::vector<float> ActiveDutyCycleInputs, OverlapDutyCycleInputs;
+
+	// If LazyDutyCycles is true, a Column's duty cycles are only updated in time steps when it is active,
+	// its overlap reaches its MinOverlap, or boosting is allowed; the decay over the steps in between is
+	// applied all at once. DutyCycleTimes holds the time step when each Column's duty cycles were last 
+	// updated, and DutyCycleTime the time step as of which they are all to be read. Defaults to false.
+	bool LazyDutyCycles;
+	std::vector<int> DutyCycleTimes;
+	int DutyCycleTime;
+
+	// The number of time steps over which spatial learning is accumulated before being applied to the proximal
+	// permanences. If 1 (the default), each winning Column's permanences are adapted every time step. Otherwise
+	// only the activity of each winning Column's synapses is counted, and the net change is applied to the
+	// permanences (and their connections brought up to date) once every SpatialLearningWindow time steps.
+	int SpatialLearningWindow;
+
 	// This Region's synapse parameters.
 	SynapseParameters ProximalSynapseParams, DistalSynapseParams;
 
@@ -168,7 +280,7 @@ public:
 	int NumOutputValues;
 
 	// The ID strings of each of this Region's input DataSpaces.
-	std::vector<QString> InputIDs;
+	std::vector<std::string> InputIDs;
 
 	// The input radius corresponding to each input DataSpace.
 	// Furthest number of hypercolumns away (in the input DataSpace's grid space) to allow proximal 
@@ -184,8 +296,11 @@ public:
 	/// Increments at every time step.
 	float StepCounter;
 
-	// For recording feature detector statistics.
-	int fd_numActiveCols, fd_missingSynapesCount, fd_extraSynapsesCount;
+	// The Statistics measured of this Region, each on its own sampled time steps. The Region owns them.
+	std::vector<Statistic*> Statistics;
+
+	// Records the time spent in each phase of Step().
+	StepProfiler Profiler;
 
 	/// Constructor
 
@@ -230,7 +345,7 @@ public:
 	/// corners in a small section without being 'distracted' by learning larger patterns
 	/// in the overall input space (which hopefully higher hierarchical Regions would 
 	/// handle more successfully).  Passing in -1 for input radius will mean no restriction.
-	Region(NetworkManager *manager, QString &_id, Point colGridSize, int hypercolumnDiameter, SynapseParameters proximalSynapseParams, SynapseParameters distalSynapseParams, float pctInputPerCol, float pctMinOverlap, int predictionRadius, InhibitionTypeEnum inhibitionType, int inhibitionRadius, float pctLocalActivity, float boostRate, float maxBoost, int spatialLearningStartTime, int spatialLearningEndTime, int temporalLearningStartTime, int temporalLearningEndTime, int boostingStartTime, int boostingEndTime, int cellsPerCol, int segActiveThreshold, int newSynapseCount, int min_MinOverlapToReuseSegment, int max_MinOverlapToReuseSegment, bool hardcodedSpatial, bool outputColumnActivity, bool outputCellActivity);
+	Region(NetworkManager *manager, const std::string &_id, Point colGridSize, int hypercolumnDiameter, SynapseParameters proximalSynapseParams, SynapseParameters distalSynapseParams, float pctInputPerCol, float pctMinOverlap, int predictionRadius, InhibitionTypeEnum inhibitionType, int inhibitionRadius, float pctLocalActivity, float boostRate, float maxBoost, int spatialLearningStartTime, int spatialLearningEndTime, int temporalLearningStartTime, int temporalLearningEndTime, int boostingStartTime, int boostingEndTime, int cellsPerCol, int segActiveThreshold, int newSynapseCount, int min_MinOverlapToReuseSegment, int max_MinOverlapToReuseSegment, bool hardcodedSpatial, bool outputColumnActivity, bool outputCellActivity);
 
 	/// Methods
 
@@ -244,6 +359,7 @@ public:
 	int GetHypercolumnDiameter() {return HypercolumnDiameter;}
 
 	bool GetIsActive(int _x, int _y, int _index);
+	const BitArray &DetermineActiveBits();
 
 	// Add an input DataSpace to this Region
 	void AddInput(DataSpace *_inputDataSpace);
@@ -266,7 +382,20 @@ public:
 
 	Cell *GetCell(int _x, int _y, int _index);
 
+	/// Returns the cell with the given number (see Cell::GetNumber()).
+	Cell *GetCellByNumber(int _number);
+
 	int GetStepCounter() {return StepCounter;}
+
+	/// Returns a pointer to this Region's count of the time steps it has been advanced through (see Epoch).
+	const int *GetEpochCounter() {return &Epoch;}
+
+	/// Buffers used by SegmentUpdateInfo::Initialize(): a bit for each of this Region's cells, set for 
+	/// the cells that are to be skipped when choosing cells to form new synapses from, and the list of 
+	/// candidate cells. All bits are clear between uses. The bits are also used by Segment::UpdatePermanences(),
+	/// to mark the input cells of a segment's active synapses.
+	BitArray SynapseCellMarks;
+	std::vector<Cell*> SynapseCandidates;
 	
 	// Called after adding all inputs to this Region.
 	void Initialize();
@@ -354,6 +483,10 @@ public:
 	/// returns: a pointer to the Column at that position.
 	Column *GetColumn(int x, int y);
 
+	/// Add to the given list the cells within the given area of columns that were learning during the previous time step, 
+	/// in order of column X and then Y, skipping the cells whose numbers (see Cell::GetNumber()) are set in _excludedCells.
+	void GetPrevLearningCells(const Area &_area, const BitArray &_excludedCells, std::vector<Cell*> &_result);
+
 	/// The radius of the average connected receptive field size of all the columns. 
 	/// 
 	/// returns: The average connected receptive field size (in hypercolumn grid space).
@@ -363,12 +496,131 @@ public:
 	/// determine the extent of lateral inhibition between columns.
 	float AverageReceptiveFieldSize();
 
+	/// Rebuild each Column's arrays of proximal synapse state, and its record of its connected 
+	/// proximal synapses. Called after the proximal synapses have been created or loaded.
+	void InitializeReceptiveFields();
+
+	/// Rebuild the index from each input value to the proximal synapses that sample it, for each
+	/// spatial pooling worker. Called after InitializeReceptiveFields().
+	void InitializeProximalInputIndices();
+
+	/// Copy each Column's proximal synapse permanences into its ProximalSynapse objects. Called 
+	/// between time steps, before the ProximalSynapse objects are saved or displayed.
+	void StoreProximalPermanences();
+
+	/// Determine the number of active connected, and active well connected, proximal synapses of the 
+	/// given worker's share of the Columns, by visiting only the synapses that sample currently active
+	/// input values. The activity of each input must already have been determined for this time step.
+	void AccumulateProximalActivity(int _workerIndex);
+
+	/// Set the number of threads that perform this Region's spatial pooling.
+	void SetNumThreads(int _numThreads);
+	int GetNumThreads() {return NumThreads;}
+
+	/// Have each spatial pooling worker run the given function, with this Region as its data, and wait for
+	/// them all to finish.
+	void RunSpatialPoolingWorkers(WorkerFunction _function);
+
+	/// The work done by each spatial pooling worker, for its own share of the Columns or hypercolumns, in 
+	/// each phase of spatial pooling.
+	static void ComputeOverlapWorker(void *_region, int _workerIndex, int _numWorkers);
+	static void ComputeInhibitionThresholdsWorker(void *_region, int _workerIndex, int _numWorkers);
+	static void ComputeColumnInhibitionWorker(void *_region, int _workerIndex, int _numWorkers);
+	static void SpatialLearningWorker(void *_region, int _workerIndex, int _numWorkers);
+
+	/// The work done by each worker, for its own share of the Columns, in each phase of a frozen Region's 
+	/// temporal pooling.
+	static void FrozenActiveStateWorker(void *_region, int _workerIndex, int _numWorkers);
+	static void FrozenPredictiveStateWorker(void *_region, int _workerIndex, int _numWorkers);
+
+	/// Freeze this Region for inference only, once its learning is finished. Its connected distal synapses 
+	/// are compiled into read-only tables, and its proximal input indices rebuilt with only the synapses that
+	/// contribute to overlap. While frozen, Step() performs no learning, boosting or duty cycle updates, and
+	/// determines cell states from the tables alone; only the Cells' own states are kept up to date.
+	void Freeze();
+
+	/// Return this Region to normal operation, discarding the frozen tables and bringing its distal 
+	/// segments' states up to date with its cells.
+	void Unfreeze();
+
+	bool IsFrozen() {return Frozen;}
+
+	/// Performs temporal pooling for a frozen Region, from the frozen tables, without learning.
+	void PerformFrozenTemporalPooling();
+
+	/// Determine the DesiredLocalActivity of each Column, if the radius in hypercolumns of the
+	/// inhibition area has changed since it was last determined (or if _force is true).
+	void UpdateDesiredLocalActivity(bool _force);
+
+	/// For each hypercolumn, determine the k'th largest overlap amongst all columns within
+	/// inhibitionRadius hypercolumns of it, where k is the DesiredLocalActivity of its columns.
+	/// 
+	/// Every column of a hypercolumn has the same inhibition area and DesiredLocalActivity, so
+	/// this is done once per hypercolumn rather than once per column. Only the hypercolumns with 
+	/// indices from _begin up to _end are determined, using the given buffer.
+	void ComputeInhibitionThresholds(int _begin, int _end, std::vector<float> &_overlaps);
+
+	/// Returns true if every hypercolumn's inhibition area covers the whole Region, in which case
+	/// inhibition is global and a single threshold applies to every column.
+	bool IsInhibitionGlobal();
+
+	/// Determine the single inhibition threshold used when inhibition is global, with one
+	/// selection pass over the overlaps of every column in the Region.
+	void ComputeGlobalInhibitionThreshold();
+
+	/// For each hypercolumn, determine the maximum ActiveDutyCycle of the columns within
+	/// inhibitionRadius hypercolumns of it.
+	///
+	/// The maximum within each hypercolumn is found first. A sliding window maximum is then run
+	/// along each row of hypercolumns and then along each column of the result, which together
+	/// give the maximum over each square inhibition area in time proportional to the number of columns.
+	void ComputeMaxDutyCycles();
+
+	/// Returns the maximum ActiveDutyCycle of the columns within inhibitionRadius hypercolumns of
+	/// the given hypercolumn, as found by the last call to ComputeMaxDutyCycles().
+	float GetNeighborhoodMaxDutyCycle(Point _hypercolumnPosition) {return NeighborhoodMaxDutyCycles[(_hypercolumnPosition.Y * HypercolumnsX) + _hypercolumnPosition.X];}
+
+	/// Update the duty cycles of the Columns with indices from _begin up to (but not including) _end, 
+	/// from their activity and overlap during the current time step.
+	/// Exponential moving average (EMA):
+	/// St = a * Yt + (1-a)*St-1
+	void UpdateDutyCycles(int _begin, int _end);
+
+	/// Returns the given Column's duty cycles, as of the most recent update.
+	float GetActiveDutyCycle(int _colIndex) {return LazyDutyCycles ? DecayMovingAverage(ActiveDutyCycles[_colIndex], EmaAlpha, DutyCycleTime - DutyCycleTimes[_colIndex]) : ActiveDutyCycles[_colIndex];}
+	float GetFastActiveDutyCycle(int _colIndex) {return LazyDutyCycles ? DecayMovingAverage(FastActiveDutyCycles[_colIndex], FastEmaAlpha, DutyCycleTime - DutyCycleTimes[_colIndex]) : FastActiveDutyCycles[_colIndex];}
+	float GetOverlapDutyCycle(int _colIndex) {return LazyDutyCycles ? DecayMovingAverage(OverlapDutyCycles[_colIndex], EmaAlpha, DutyCycleTime - DutyCycleTimes[_colIndex]) : OverlapDutyCycles[_colIndex];}
+
+	/// Set the given Column's duty cycles, as of the most recent update. Used when loading a saved network.
+	void SetDutyCycles(int _colIndex, float _overlapDutyCycle, float _activeDutyCycle, float _fastActiveDutyCycle);
+
+	/// Set whether Columns' duty cycles are updated lazily, only when they are active or have overlap
+	/// (or while boosting is allowed). Must be called before the Region is run.
+	void SetLazyDutyCycles(bool _lazyDutyCycles) {LazyDutyCycles = _lazyDutyCycles;}
+	bool GetLazyDutyCycles() {return LazyDutyCycles;}
+
+	/// Set the number of time steps over which spatial learning is accumulated before being applied to the
+	/// proximal permanences. Must be called before the Region is initialized.
+	void SetSpatialLearningWindow(int _spatialLearningWindow) {SpatialLearningWindow = _spatialLearningWindow;}
+	int GetSpatialLearningWindow() {return SpatialLearningWindow;}
+
+	/// Set the format in which this Region's proximal and distal synapse permanences are stored, rounding its
+	/// synapse parameters to that format's steps. Must be called before the Region is initialized.
+	void SetPermanenceFormat(PermanenceFormat _format) {ProximalSynapseParams.SetFormat(_format); DistalSynapseParams.SetFormat(_format);}
+	PermanenceFormat GetPermanenceFormat() {return ProximalSynapseParams.Format;}
+
+	/// Returns the k'th largest overlap amongst the columns within the given area. Returns FLT_MAX
+	/// if k is 0, so that no column is within the k'th score, and -FLT_MAX if k is larger than the
+	/// area, so that every column is. The given buffer is used to gather the overlaps.
+	float DetermineKthLargestOverlap(Area &_area, int _k, std::vector<float> &_overlaps);
+
 	/// Return true if the given Column has an overlap value that is at least the
 	/// k'th largest amongst all neighboring columns within inhibitionRadius.
+	/// ComputeInhibitionThresholds() must have been called since overlaps were last computed.
 	///
 	/// This function is effectively determining which columns are to be inhibited 
 	/// during the spatial pooling procedure of the region.
-	bool IsWithinKthScore(Column *col, int k);
+	bool IsWithinKthScore(Column *col);
 
 	/// Update the values of the inputData for this <see cref="Region"/> by copying row 
 	/// references from the specified newInput parameter.
@@ -391,6 +643,16 @@ public:
 
 	/// Updates statistics values.
 	void ComputeBasicStatistics();
-	void ComputeColumnAccuracy();
+
+	/// Have each of this Region's Statistics take a sample and record a report, if due.
+	void ComputeStatistics();
+
+	/// Add a Statistic to be measured of this Region, which takes ownership of it.
+	void AddStatistic(Statistic *_statistic) {Statistics.push_back(_statistic);}
+
+	/// Returns this Region's Statistic with the given ID (compared without regard to case), or NULL if there is none.
+	Statistic *GetStatistic(const std::string &_id);
+
+	StepProfiler &GetProfiler() {return Profiler;}
 };
 
@@ -1,4 +1,13 @@
 #include "Segment.h"
+#include "Cell.h"
+#include "Column.h"
+#include "Region.h"
+
+// Distal segments gather their input cells' states eight at a time with AVX2, when building for it on x64.
+#if defined(__AVX2__) && (defined(_M_X64) || defined(__x86_64__))
+#include <immintrin.h>
+#define SEGMENT_GATHER_AVX2
+#endif
 
 extern MemManager mem_manager;
 
@@ -18,64 +27,98 @@ void Segment::Retire()
 		mem_manager.ReleaseObject(curSynapse);
 	}
 
-	ActiveSynapses.Clear();
-	PrevActiveSynapses.Clear();
+	// Release all distal synapses.
+	if (ParentCell != NULL) {
+		RemoveAllDistalSynapses();
+	}
 }
 
 /// Returns true if the number of connected synapses on this 
 /// Segment that were active due to learning states at time t-1 is 
-/// greater than activationThreshold.   
-bool Segment::GetWasActiveFromLearning()
+/// greater than activationThreshold. The cells' previous states are read from 
+/// the given Region's CellStates.Previous.
+bool Segment::GetWasActiveFromLearning(const unsigned char *_prevCellStates)
 {
+	const unsigned char activeFromLearning = CELL_STATE_ACTIVE | CELL_STATE_LEARNING;
 	int numberSynapsesWasActive = 0;
-	FastListIter synapses_iter(Synapses);
-	Synapse *syn;
+	int numSynapses = (int)SynapseCells.size();
+	const int *synapseCells = (numSynapses == 0) ? NULL : &(SynapseCells[0]);
 
-	for (syn = (Synapse*)(synapses_iter.Reset()); syn != NULL; syn = (Synapse*)(synapses_iter.Advance()))
-	{
-		numberSynapsesWasActive += syn->GetWasActiveFromLearning() ? 1 : 0;
+	// Gather the previous state of each synapse's input cell. The loop is branch free, so that the compiler can vectorize it.
+	for (int i = 0; i < numSynapses; i++) {
+		numberSynapsesWasActive += ((_prevCellStates[synapseCells[i]] & activeFromLearning) == activeFromLearning) ? 1 : 0;
 	}
+
 	return numberSynapsesWasActive >= ActiveThreshold;
 }
 
 /// Methods
 
 /// Initializes a new instance of the Segment class.
+/// parentCell: The Cell that this segment belongs to, or NULL for a proximal segment.
+/// epoch: The owning Region's count of time steps (see Region::GetEpochCounter()).
 /// activeThreshold: A threshold number of active synapses between 
 /// active and non-active Segment state.
-void Segment::Initialize(int creationTime, float activeThreshold)
+void Segment::Initialize(Cell *parentCell, const int *epoch, int creationTime, float activeThreshold)
 {
+	ParentCell = parentCell;
+	Params = (parentCell == NULL) ? NULL : &(parentCell->GetColumn()->GetRegion()->DistalSynapseParams);
+	Epoch = epoch;
+	StateEpoch = *epoch;
 	IsSequence = false;
 	_numPredictionSteps = -1;
 	ActiveThreshold = activeThreshold;
 	ConnectedSynapsesCount = 0;
+	PrevConnectedSynapsesCount = 0;
 	ActiveConnectedSynapsesCount = 0;
 	PrevActiveConnectedSynapsesCount = 0;
 	ActiveLearningSynapsesCount = 0;
 	PrevActiveLearningSynapsesCount = 0;
 	InactiveWellConnectedSynapsesCount = 0;
+	ActiveWellConnectedSynapsesCount = 0;
+	ActiveSynapsesCount = 0;
+	PrevActiveSynapsesCount = 0;
+	TouchedEpoch = -1;
+	ProcessedEpoch = -1;
+	NumConnectedSynapses = 0;
+	NumWellConnectedSynapses = 0;
 	IsActive = false;
 	WasActive = false;
 	CreationTime = creationTime;
 }
 
-/// Advance this segment to the next time step.
+/// Advance this segment's state to the current time step.
 ///
-/// The current state of this segment (active, number of synapes) will be set as 
-/// the previous state and the current state will be reset to no cell activity by 
-/// default until it can be determined.
-void Segment::NextTimeStep()
+/// If the state is of the previous time step, it becomes the previous state. Otherwise
+/// the segment hasn't been accessed since before then, so it had no activity in the previous 
+/// time step. The current state is reset to no cell activity by default until it can be determined.
+void Segment::AdvanceState()
 {
-	WasActive = IsActive;
+	if (StateEpoch == (*Epoch - 1))
+	{
+		WasActive = IsActive;
+		PrevConnectedSynapsesCount = ConnectedSynapsesCount;
+		PrevActiveConnectedSynapsesCount = ActiveConnectedSynapsesCount;
+		PrevActiveLearningSynapsesCount = ActiveLearningSynapsesCount;
+		PrevActiveSynapsesCount = ActiveSynapsesCount;
+	}
+	else
+	{
+		WasActive = false;
+		PrevConnectedSynapsesCount = NumConnectedSynapses;
+		PrevActiveConnectedSynapsesCount = 0;
+		PrevActiveLearningSynapsesCount = 0;
+		PrevActiveSynapsesCount = 0;
+	}
+
 	IsActive = false;
-	PrevConnectedSynapsesCount = ConnectedSynapsesCount;
-	PrevActiveConnectedSynapsesCount = ActiveConnectedSynapsesCount;
+	ActiveSynapsesCount = 0;
 	ActiveConnectedSynapsesCount = 0;
-	PrevActiveLearningSynapsesCount = ActiveLearningSynapsesCount;
 	ActiveLearningSynapsesCount = 0;
-	PrevActiveSynapses.Clear();
-	ActiveSynapses.TransferContentsTo(PrevActiveSynapses);
-	InactiveWellConnectedSynapsesCount = 0;
+	ActiveWellConnectedSynapsesCount = 0;
+	ConnectedSynapsesCount = NumConnectedSynapses;
+	InactiveWellConnectedSynapsesCount = NumWellConnectedSynapses;
+	StateEpoch = *Epoch;
 }
 
 /// Process this segment for the current time step.
@@ -85,47 +128,151 @@ void Segment::NextTimeStep()
 /// From there we will determine if this segment is active if enough active connected
 /// synapses are present.  This information is then cached for the remainder of the
 /// Region's processing for the time step.  When a new time step occurs, the
-/// Region will call nextTimeStep() on all cells/segments to cache the 
+/// segment's state is advanced when it is next accessed, to cache the 
 /// information as which synapses were previously active.
-void Segment::ProcessSegment()
+///
+/// The synapses' input cell states are gathered from _cellStates by their SynapseCells. During a Region's time step, 
+/// only the segments touched by an active cell are processed (see Region::PerformTemporalPooling()).
+void Segment::ProcessSegment(const unsigned char *_cellStates)
 {
-	ConnectedSynapsesCount = 0;
+	int numSynapses = GetNumDistalSynapses();
+	const int *synapseCells = (numSynapses == 0) ? NULL : &(SynapseCells[0]);
+	const unsigned char *synapseConnected = (numSynapses == 0) ? NULL : &(SynapseConnected[0]);
+	const unsigned char *synapseWellConnected = (numSynapses == 0) ? NULL : &(SynapseWellConnected[0]);
+	unsigned char cellState;
+	int i = 0;
+
+	Refresh();
+
+	// If this segment has already been processed during this time step, undo the record of which synapses were active.
+	if (ProcessedEpoch == StateEpoch)
+	{
+		for (i = 0; i < numSynapses; i++)
+		{
+			if (SynapseActiveEpochs[i] == StateEpoch) {
+				SynapseActiveEpochs[i] = SynapsePrevActiveEpochs[i];
+			}
+		}
+	}
+
+	ProcessedEpoch = StateEpoch;
+
+	ActiveSynapsesCount = 0;
 	ActiveConnectedSynapsesCount = 0;
 	ActiveLearningSynapsesCount = 0;
-	InactiveWellConnectedSynapsesCount = 0;
+	ActiveWellConnectedSynapsesCount = 0;
 
-	ActiveSynapses.Clear();
+	i = 0;
 
-	FastListIter synapses_iter(Synapses);
-	for (Synapse *syn = (Synapse*)(synapses_iter.Reset()); syn != NULL; syn = (Synapse*)(synapses_iter.Advance()))
+#ifdef SEGMENT_GATHER_AVX2
+	// Gather the states of eight input cells at a time. Each gather reads a 32 bit word at the cell's state, of which only 
+	// the low byte is used; CellStateBuffers are padded so that this can't read past their end. Only the active synapses,
+	// which are few, are then visited one at a time, to record that they are active.
+	const __m256i activeFlag = _mm256_set1_epi32(CELL_STATE_ACTIVE);
+	const __m256i learningFlags = _mm256_set1_epi32(CELL_STATE_ACTIVE | CELL_STATE_LEARNING);
+	__m256i activeSum = _mm256_setzero_si256(), connectedSum = _mm256_setzero_si256();
+	__m256i learningSum = _mm256_setzero_si256(), wellConnectedSum = _mm256_setzero_si256();
+	__m256i states, active, learning, connected, wellConnected;
+	int activeLanes, sums[8];
+
+	for (; i + 8 <= numSynapses; i += 8)
 	{
-		if (syn->GetIsActive())
-		{
-			ActiveSynapses.InsertAtEnd(syn);
+		states = _mm256_i32gather_epi32((const int*)_cellStates, _mm256_loadu_si256((const __m256i*)(synapseCells + i)), 1);
+		active = _mm256_cmpeq_epi32(_mm256_and_si256(states, activeFlag), activeFlag);
+		learning = _mm256_cmpeq_epi32(_mm256_and_si256(states, learningFlags), learningFlags);
+		connected = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(synapseConnected + i)));
+		wellConnected = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(synapseWellConnected + i)));
 
-			if (syn->GetIsConnected()) {
-				ActiveConnectedSynapsesCount++;
-			}
+		// The comparisons give -1 in each lane that matches, and the connected flags 1 in each lane that is connected.
+		activeSum = _mm256_sub_epi32(activeSum, active);
+		learningSum = _mm256_sub_epi32(learningSum, learning);
+		connectedSum = _mm256_add_epi32(connectedSum, _mm256_and_si256(active, connected));
+		wellConnectedSum = _mm256_add_epi32(wellConnectedSum, _mm256_and_si256(active, wellConnected));
 
-			if (syn->GetIsActiveFromLearning()) {
-				ActiveLearningSynapsesCount++;
-			}
+		for (activeLanes = _mm256_movemask_ps(_mm256_castsi256_ps(active)); activeLanes != 0; activeLanes &= (activeLanes - 1)) {
+			StampSynapseActive(i + LowestSetBit((BitWord)activeLanes));
 		}
-		else
+	}
+
+	_mm256_storeu_si256((__m256i*)sums, activeSum);
+	ActiveSynapsesCount = sums[0] + sums[1] + sums[2] + sums[3] + sums[4] + sums[5] + sums[6] + sums[7];
+	_mm256_storeu_si256((__m256i*)sums, learningSum);
+	ActiveLearningSynapsesCount = sums[0] + sums[1] + sums[2] + sums[3] + sums[4] + sums[5] + sums[6] + sums[7];
+	_mm256_storeu_si256((__m256i*)sums, connectedSum);
+	ActiveConnectedSynapsesCount = sums[0] + sums[1] + sums[2] + sums[3] + sums[4] + sums[5] + sums[6] + sums[7];
+	_mm256_storeu_si256((__m256i*)sums, wellConnectedSum);
+	ActiveWellConnectedSynapsesCount = sums[0] + sums[1] + sums[2] + sums[3] + sums[4] + sums[5] + sums[6] + sums[7];
+#endif
+
+	// Gather the states of the remaining input cells one at a time.
+	for (; i < numSynapses; i++)
+	{
+		cellState = _cellStates[synapseCells[i]];
+
+		if (cellState & CELL_STATE_ACTIVE) 
 		{
-			if (syn->GetPermanence() > syn->Params->InitialPermanence) {
-				InactiveWellConnectedSynapsesCount++;
+			ActiveSynapsesCount++;
+			ActiveConnectedSynapsesCount += synapseConnected[i];
+			ActiveWellConnectedSynapsesCount += synapseWellConnected[i];
+
+			if (cellState & CELL_STATE_LEARNING) {
+				ActiveLearningSynapsesCount++;
 			}
-		}
 
-		if (syn->GetIsConnected()) {
-			ConnectedSynapsesCount++;
+			StampSynapseActive(i);
 		}
 	}
 
+	ConnectedSynapsesCount = NumConnectedSynapses;
+	InactiveWellConnectedSynapsesCount = NumWellConnectedSynapses - ActiveWellConnectedSynapsesCount;
+
 	IsActive = (ActiveConnectedSynapsesCount >= ActiveThreshold);
 }
 
+float Segment::GetSynapsePermanence(int _index)
+{
+	switch (Params->Format)
+	{
+	case PERMANENCE_FORMAT_16BIT:
+		return Params->UnitsToPermanence(SynapsePermanences16[_index]);
+	case PERMANENCE_FORMAT_8BIT:
+		return Params->UnitsToPermanence(SynapsePermanences8[_index]);
+	default:
+		return SynapsePermanences[_index];
+	}
+}
+
+void Segment::SetSynapsePermanence(int _index, float _permanence)
+{
+	switch (Params->Format)
+	{
+	case PERMANENCE_FORMAT_16BIT:
+		SynapsePermanences16[_index] = (unsigned short)(Params->PermanenceToUnits(_permanence));
+		break;
+	case PERMANENCE_FORMAT_8BIT:
+		SynapsePermanences8[_index] = (unsigned char)(Params->PermanenceToUnits(_permanence));
+		break;
+	default:
+		SynapsePermanences[_index] = _permanence;
+		break;
+	}
+
+	// Update whether the synapse is connected and well connected, and the counts of those that are.
+	_permanence = GetSynapsePermanence(_index);
+	unsigned char connected = (_permanence >= Params->ConnectedPerm) ? 1 : 0;
+	unsigned char wellConnected = (_permanence > Params->InitialPermanence) ? 1 : 0;
+	NumConnectedSynapses += connected - SynapseConnected[_index];
+	NumWellConnectedSynapses += wellConnected - SynapseWellConnected[_index];
+	SynapseConnected[_index] = connected;
+	SynapseWellConnected[_index] = wellConnected;
+}
+
+/// Returns the input Cell of the distal synapse with the given index.
+Cell *Segment::GetSynapseInputCell(int _index)
+{
+	return ParentCell->GetColumn()->GetRegion()->GetCellByNumber(SynapseCells[_index]);
+}
+
 /// Create a new proximal synapse for this segment attached to the specified 
 /// input cell.
 /// inputSource: the input source of the synapse to create.
@@ -139,47 +286,169 @@ ProximalSynapse *Segment::CreateProximalSynapse(SynapseParameters *params, DataS
 	return newSyn;
 }
 
-/// Create a new synapse for this segment attached to the specified input source.
+/// Create a new distal synapse for this segment attached to the specified input cell, 
+/// and add this segment to that cell's list of OutputSegments.
 /// inputSource: the input source of the synapse to create.
 /// initPerm: the initial permanence of the synapse.
-/// Returns the newly created synapse.
-DistalSynapse *Segment::CreateDistalSynapse(SynapseParameters *params, Cell *inputSource, float initPerm)
+void Segment::CreateDistalSynapse(Cell *inputSource, float initPerm)
 {
-	DistalSynapse *newSyn = (DistalSynapse*)(mem_manager.GetObject(MOT_DISTAL_SYNAPSE));
-	newSyn->Initialize(params, inputSource, initPerm);
-	Synapses.InsertAtEnd(newSyn);
-	return newSyn;
+	SynapseCells.push_back(inputSource->GetNumber());
+
+	switch (Params->Format)
+	{
+	case PERMANENCE_FORMAT_16BIT:
+		SynapsePermanences16.push_back(0);
+		break;
+	case PERMANENCE_FORMAT_8BIT:
+		SynapsePermanences8.push_back(0);
+		break;
+	default:
+		SynapsePermanences.push_back(0.0f);
+		break;
+	}
+
+	SynapseConnected.push_back(0);
+	SynapseWellConnected.push_back(0);
+	SynapseActiveEpochs.push_back(-1);
+	SynapsePrevActiveEpochs.push_back(-1);
+
+	SetSynapsePermanence(GetNumDistalSynapses() - 1, initPerm);
+
+	inputSource->AddOutputSegment(this);
 }
 
 /// Create numSynapses new synapses attached to the specified
 /// set of learning cells.
 /// synapseCells: Set of available learning cells to form synapses to.
-/// added: Set will be populated with synapses that were successfully added.
-void Segment::CreateSynapsesToLearningCells(FastList &synapseCells, SynapseParameters *params)
+void Segment::CreateSynapsesToLearningCells(std::vector<Cell*> &synapseCells)
 {
-	DistalSynapse *newSyn;
-
 	// Assume that cells were previously checked to prevent adding
 	// synapses to the same cell more than once per segment.
-	FastListIter cells_iter(synapseCells);
-	for (Cell *cell = (Cell*)(cells_iter.Reset()); cell != NULL; cell = (Cell*)(cells_iter.Advance()))
+	for (int i = 0; i < (int)synapseCells.size(); i++)
 	{
-		newSyn = CreateDistalSynapse(params, cell, params->InitialPermanence);
+		CreateDistalSynapse(synapseCells[i], Params->InitialPermanence);
 	}
 }
 
-/// Return a count of how many synapses on this segment (whether connected or not) 
-/// are active in the current time step.
-int Segment::GetActiveSynapseCount()
+/// Remove the synapse with the given index from its input cell's list of OutputSegments.
+void Segment::UnbindSynapse(int _index)
 {
-	return ActiveSynapses.Count();
+	GetSynapseInputCell(_index)->RemoveOutputSegment(this);
 }
 
-/// Return a count of how many synapses on this segment (whether connected or not) 
-/// were active in the previous time step.
-int Segment::GetPrevActiveSynapseCount()
+template <class T>
+static void MoveEntry(std::vector<T> &_array, int _from, int _to)
 {
-	return PrevActiveSynapses.Count();
+	if (_array.empty() == false) {
+		_array[_to] = _array[_from];
+	}
+}
+
+template <class T>
+static void TruncateArray(std::vector<T> &_array, int _size)
+{
+	if (_array.empty() == false) {
+		_array.resize(_size);
+	}
+}
+
+/// Remove the distal synapses whose permanence has reached 0, keeping the order of the others.
+void Segment::RemoveZeroPermanenceSynapses()
+{
+	int numSynapses = GetNumDistalSynapses(), numKept = 0;
+
+	for (int i = 0; i < numSynapses; i++)
+	{
+		if (GetSynapsePermanence(i) == 0.0f)
+		{
+			// Remove the current synapse, whose permanence has reached 0.
+			UnbindSynapse(i);
+			NumConnectedSynapses -= SynapseConnected[i];
+			NumWellConnectedSynapses -= SynapseWellConnected[i];
+			continue;
+		}
+
+		// Move the current synapse down into the place of those removed before it.
+		if (numKept != i)
+		{
+			MoveEntry(SynapseCells, i, numKept);
+			MoveEntry(SynapsePermanences, i, numKept);
+			MoveEntry(SynapsePermanences16, i, numKept);
+			MoveEntry(SynapsePermanences8, i, numKept);
+			MoveEntry(SynapseConnected, i, numKept);
+			MoveEntry(SynapseWellConnected, i, numKept);
+			MoveEntry(SynapseActiveEpochs, i, numKept);
+			MoveEntry(SynapsePrevActiveEpochs, i, numKept);
+		}
+
+		numKept++;
+	}
+
+	TruncateArray(SynapseCells, numKept);
+	TruncateArray(SynapsePermanences, numKept);
+	TruncateArray(SynapsePermanences16, numKept);
+	TruncateArray(SynapsePermanences8, numKept);
+	TruncateArray(SynapseConnected, numKept);
+	TruncateArray(SynapseWellConnected, numKept);
+	TruncateArray(SynapseActiveEpochs, numKept);
+	TruncateArray(SynapsePrevActiveEpochs, numKept);
+}
+
+/// Remove all of this distal segment's synapses.
+void Segment::RemoveAllDistalSynapses()
+{
+	for (int i = 0; i < GetNumDistalSynapses(); i++) {
+		UnbindSynapse(i);
+	}
+
+	SynapseCells.clear();
+	SynapsePermanences.clear();
+	SynapsePermanences16.clear();
+	SynapsePermanences8.clear();
+	SynapseConnected.clear();
+	SynapseWellConnected.clear();
+	SynapseActiveEpochs.clear();
+	SynapsePrevActiveEpochs.clear();
+
+	NumConnectedSynapses = 0;
+	NumWellConnectedSynapses = 0;
+}
+
+/// Add to the given list the input cell numbers of all active synapses as computed as of the most recently 
+/// processed time step for this segment.
+void Segment::GetActiveSynapseCells(std::vector<int> &_result)
+{
+	Refresh();
+
+	if (ActiveSynapsesCount == 0) {
+		return;
+	}
+
+	for (int i = 0; i < GetNumDistalSynapses(); i++)
+	{
+		if (SynapseActiveEpochs[i] == StateEpoch) {
+			_result.push_back(SynapseCells[i]);
+		}
+	}
+}
+
+/// Add to the given list the input cell numbers of all previously active (in t-1) synapses as computed as of 
+/// the most recently processed time step for this segment.
+void Segment::GetPrevActiveSynapseCells(std::vector<int> &_result)
+{
+	Refresh();
+
+	if (PrevActiveSynapsesCount == 0) {
+		return;
+	}
+
+	// A synapse that has also been active in the current time step keeps the time step at which it was previously active in SynapsePrevActiveEpochs.
+	for (int i = 0; i < GetNumDistalSynapses(); i++)
+	{
+		if ((SynapseActiveEpochs[i] == (StateEpoch - 1)) || (SynapsePrevActiveEpochs[i] == (StateEpoch - 1))) {
+			_result.push_back(SynapseCells[i]);
+		}
+	}
 }
 
 /// Update all permanence values of each synapse based on current activity.
@@ -200,44 +469,92 @@ void Segment::AdaptPermanences()
 	}
 }
 
-/// Update (increase or decrease based on whether the synapse is active)
-/// all permanence values of each of the synapses in the specified set.
-void Segment::UpdatePermanences(FastList &activeSynapses)
+/// Apply a learning step to each of a distal segment's permanences, within [0, 1]. If _reinforce, those whose input cell
+/// is set in _activeCells are increased and the others decreased; otherwise only those whose input cell is set are 
+/// decreased. Records whether each is connected and well connected, and counts those that are.
+template <class T>
+static void UpdatePermanenceValues(T *_perms, int _count, const int *_cells, const BitArray &_activeCells, bool _reinforce, const SynapseParameters &_params, unsigned char *_connected, unsigned char *_wellConnected, int &_connectedCount, int &_wellConnectedCount)
 {
-	Synapse *syn;
-	FastListIter synapses_iter;
+	typename PermanenceSum<T>::Type permanenceInc = StoredPermanence<T>(_params, _params.PermanenceInc);
+	typename PermanenceSum<T>::Type permanenceDec = StoredPermanence<T>(_params, _params.PermanenceDec);
+	T connectedPerm = StoredPermanence<T>(_params, _params.ConnectedPerm);
+	T initialPermanence = StoredPermanence<T>(_params, _params.InitialPermanence);
+	T maxPerm = StoredPermanence<T>(_params, 1.0f);
+	typename PermanenceSum<T>::Type perm;
+	bool active;
+
+	_connectedCount = 0;
+	_wellConnectedCount = 0;
 
-	// Decrease all synapses first...
-	synapses_iter.SetList(Synapses);
-	for (syn = (Synapse*)(synapses_iter.Reset()); syn != NULL; syn = (Synapse*)(synapses_iter.Advance()))
+	for (int i = 0; i < _count; i++)
 	{
-		syn->DecreasePermanenceNoLimit();
+		active = _activeCells.Get(_cells[i]);
+		perm = _perms[i];
+
+		if (_reinforce)
+		{
+			// Decrease every synapse first, then for each active synapse, undo its decrement and add an increment. 
+			// The decrement is done without enforcing a limit, so as to avoid an incorrect amount of increment.
+			perm = perm - permanenceDec;
+			perm = active ? Min(maxPerm, perm + (permanenceDec + permanenceInc)) : Max(0, perm);
+		}
+		else if (active)
+		{
+			perm = Max(0, perm - permanenceDec);
+		}
+
+		_perms[i] = (T)perm;
+		_connected[i] = (perm >= connectedPerm) ? 1 : 0;
+		_wellConnected[i] = (perm > initialPermanence) ? 1 : 0;
+		_connectedCount += _connected[i];
+		_wellConnectedCount += _wellConnected[i];
 	}
+}
 
-	// Then for each active synapse, undo its decrement and add an increment.
-	synapses_iter.SetList(activeSynapses);
-	for (syn = (Synapse*)(synapses_iter.Reset()); syn != NULL; syn = (Synapse*)(synapses_iter.Advance()))
-	{
-		syn->IncreasePermanence(syn->Params->PermanenceDec + syn->Params->PermanenceInc);
+/// Apply a learning step to the permanences of this distal segment's synapses, in place (see UpdatePermanenceValues()). 
+/// The input cells of the active synapses are marked in _cellMarks while it is applied.
+void Segment::ApplyPermanenceChange(const std::vector<int> &_activeCells, BitArray &_cellMarks, bool _reinforce)
+{
+	int numSynapses = GetNumDistalSynapses();
+
+	if (numSynapses == 0) {
+		return;
 	}
 
-	// No make sure that all synapse permanence values are >= 0, since the decrement was done without enforcing a limit 
-	// (so as to avoid incorrect amount of increment).
-	synapses_iter.SetList(Synapses);
-	for (syn = (Synapse*)(synapses_iter.Reset()); syn != NULL; syn = (Synapse*)(synapses_iter.Advance()))
+	for (int i = 0; i < (int)_activeCells.size(); i++) {
+		_cellMarks.Set(_activeCells[i], true);
+	}
+
+	switch (Params->Format)
 	{
-		syn->LimitPermanenceAfterDecrease();
+	case PERMANENCE_FORMAT_16BIT:
+		UpdatePermanenceValues(&(SynapsePermanences16[0]), numSynapses, &(SynapseCells[0]), _cellMarks, _reinforce, *Params, &(SynapseConnected[0]), &(SynapseWellConnected[0]), NumConnectedSynapses, NumWellConnectedSynapses);
+		break;
+	case PERMANENCE_FORMAT_8BIT:
+		UpdatePermanenceValues(&(SynapsePermanences8[0]), numSynapses, &(SynapseCells[0]), _cellMarks, _reinforce, *Params, &(SynapseConnected[0]), &(SynapseWellConnected[0]), NumConnectedSynapses, NumWellConnectedSynapses);
+		break;
+	default:
+		UpdatePermanenceValues(&(SynapsePermanences[0]), numSynapses, &(SynapseCells[0]), _cellMarks, _reinforce, *Params, &(SynapseConnected[0]), &(SynapseWellConnected[0]), NumConnectedSynapses, NumWellConnectedSynapses);
+		break;
+	}
+
+	for (int i = 0; i < (int)_activeCells.size(); i++) {
+		_cellMarks.Set(_activeCells[i], false);
 	}
 }
 
+/// Update (increase or decrease based on whether the synapse is active)
+/// all permanence values of each of the synapses of this distal segment.
+/// activeCells: the input cell numbers of the active synapses.
+/// cellMarks: a bit for each of the Region's cells, all clear (see Region::SynapseCellMarks).
+void Segment::UpdatePermanences(const std::vector<int> &activeCells, BitArray &cellMarks)
+{
+	ApplyPermanenceChange(activeCells, cellMarks, true);
+}
+
 /// Decrease the permanences of each of the synapses in the set of
 /// active synapses that happen to be on this segment.
-void Segment::DecreasePermanences(FastList &activeSynapses)
+void Segment::DecreasePermanences(const std::vector<int> &activeCells, BitArray &cellMarks)
 {
-	// Decrease the permanence of each synapse on this segment.
-	FastListIter synapses_iter(activeSynapses);
-	for (Synapse *syn = (Synapse*)(synapses_iter.Reset()); syn != NULL; syn = (Synapse*)(synapses_iter.Advance()))
-	{
-		syn->DecreasePermanence();
-	}
-}
\ No newline at end of file
+	ApplyPermanenceChange(activeCells, cellMarks, false);
+}
@@ -1,12 +1,14 @@
 #pragma once
+#include <vector>
 #include "Utils.h"
 #include "MemObject.h"
 #include "MemManager.h"
 #include "FastList.h"
-#include "DistalSynapse.h"
+#include "BitArray.h"
 #include "ProximalSynapse.h"
 
 class DataSpace;
+class Cell;
 
 /// Represents a single dendrite segment that forms synapses (connections) to other Cells.
 /// 
@@ -37,13 +39,65 @@ private:
 	bool IsActive, WasActive, IsSequence;
 	int ActiveConnectedSynapsesCount, PrevActiveConnectedSynapsesCount;
 	int ActiveLearningSynapsesCount, PrevActiveLearningSynapsesCount;
-	int InactiveWellConnectedSynapsesCount;
+	int InactiveWellConnectedSynapsesCount, ActiveWellConnectedSynapsesCount;
 	int CreationTime;
 
+	// The Cell that this distal segment belongs to (NULL for a proximal segment).
+	Cell *ParentCell;
+
+	// The parameters of this distal segment's synapses, which determine the format of their permanences (NULL for a proximal segment).
+	SynapseParameters *Params;
+
+	// This segment's state is advanced lazily, when it is next accessed, rather than at the start of every time step. 
+	// Epoch points to the owning Region's count of time steps, and StateEpoch is the value of that count as of which 
+	// the current state was last advanced. If they differ, the state is out of date and is advanced by AdvanceState().
+	const int *Epoch;
+	int StateEpoch;
+
+	// The number of synapses that are active as of the most recently processed time step for this segment, and 
+	// the number that were active in t-1. Which synapses they are is recorded by SynapseActiveEpochs and 
+	// SynapsePrevActiveEpochs, and a list of them is only compiled when needed, by GetActiveSynapseCells().
+	int ActiveSynapsesCount, PrevActiveSynapsesCount;
+
+	// The epochs at which this segment was last touched by one of its input cells (see Touch()), and last processed.
+	int TouchedEpoch, ProcessedEpoch;
+
+	// The number of this segment's synapses that are connected, and that have permanence above InitialPermanence,
+	// kept up to date as synapses are created and removed and their permanences change.
+	int NumConnectedSynapses, NumWellConnectedSynapses;
+
 	void SetIsActive(bool value) {IsActive = value;}
 	void SetWasActive(bool value) {WasActive = value;}
 
+	/// Bring this segment's state up to date with the current time step, if it is out of date.
+	void Refresh()
+	{
+		if (StateEpoch != *Epoch) {
+			AdvanceState();
+		}
+	}
+
+	void AdvanceState();
+
 	void SetActiveThreshold(float value) {ActiveThreshold = value;}
+
+	/// Record that the synapse with the given index is active in the current time step, keeping the time step 
+	/// at which it was previously active.
+	void StampSynapseActive(int _index)
+	{
+		if (SynapseActiveEpochs[_index] != StateEpoch)
+		{
+			SynapsePrevActiveEpochs[_index] = SynapseActiveEpochs[_index];
+			SynapseActiveEpochs[_index] = StateEpoch;
+		}
+	}
+
+	/// Apply a learning step in place to the permanences of this segment's synapses, given the input cells of its active 
+	/// synapses, whose bits are set in _cellMarks while it is applied (see UpdatePermanences() and DecreasePermanences()).
+	void ApplyPermanenceChange(const std::vector<int> &_activeCells, BitArray &_cellMarks, bool _reinforce);
+
+	/// Remove the synapse with the given index from its input cell's list of OutputSegments.
+	void UnbindSynapse(int _index);
 			
 public:
 
@@ -56,27 +110,54 @@ public:
 	/// Returns true if the number of connected synapses on this 
 	/// Segment that are active due to active states at time t is 
 	/// greater than activationThreshold.
-	bool GetIsActive() {return IsActive;}
+	bool GetIsActive() {Refresh(); return IsActive;}
 
 	/// Returns true if the number of connected synapses on this segmentUpdateList
 	/// that were active due to active states at time t-1 is greater than ActiveThreshold.
-	bool GetWasActive() {return WasActive;}
+	bool GetWasActive() {Refresh(); return WasActive;}
 
 	/// Returns true if the number of connected synapses on this 
 	/// Segment that were active due to learning states at time t-1 is 
-	/// greater than activationThreshold.   
-	bool GetWasActiveFromLearning();
+	/// greater than activationThreshold. The cells' previous states are read from 
+	/// the given Region's CellStates.Previous.
+	bool GetWasActiveFromLearning(const unsigned char *_prevCellStates);
 
-	/// The synapses list.
+	/// The proximal synapses list. A distal segment keeps its synapses in the arrays below instead.
 	FastList Synapses;
 
-	/// The list of all active synapses as computed as of the most recently processed
-	/// time step for this segment.
-	FastList ActiveSynapses;
+	/// A distal segment's synapses, each being the entries at the same index in these arrays: the number of its input 
+	/// Cell (see Cell::GetNumber()), its permanence, whether it is connected and whether its permanence is above 
+	/// InitialPermanence, and the epochs at which it was last and previously active (-1 if never). The permanences 
+	/// are stored as floats in SynapsePermanences, or as fixed point values in SynapsePermanences16 or 
+	/// SynapsePermanences8, according to the Format of the Region's DistalSynapseParams; the other two are empty.
+	/// The synapses' activity is determined by gathering their input cells' states from the Region's CellStates.
+	std::vector<int> SynapseCells;
+	std::vector<float> SynapsePermanences;
+	std::vector<unsigned short> SynapsePermanences16;
+	std::vector<unsigned char> SynapsePermanences8;
+	std::vector<unsigned char> SynapseConnected, SynapseWellConnected;
+	std::vector<int> SynapseActiveEpochs, SynapsePrevActiveEpochs;
 
-	/// The list of all previously active (in t-1) synapses as computed as of the most
-	/// recently processed time step for this segment.
-	FastList PrevActiveSynapses;
+	/// The number of this distal segment's synapses.
+	int GetNumDistalSynapses() {return (int)SynapseCells.size();}
+
+	/// Get or set the permanence of the distal synapse with the given index. Setting it updates whether the synapse is connected.
+	float GetSynapsePermanence(int _index);
+	void SetSynapsePermanence(int _index, float _permanence);
+
+	/// Returns the input Cell of the distal synapse with the given index.
+	Cell *GetSynapseInputCell(int _index);
+
+	/// Add to the given list the input cell numbers of all active synapses as computed as of the most recently 
+	/// processed time step for this segment.
+	void GetActiveSynapseCells(std::vector<int> &_result);
+
+	/// Add to the given list the input cell numbers of all previously active (in t-1) synapses as computed as of 
+	/// the most recently processed time step for this segment.
+	void GetPrevActiveSynapseCells(std::vector<int> &_result);
+
+	/// The Cell that this distal segment belongs to.
+	Cell *GetParentCell() {return ParentCell;}
 
 	/// Returns true if the Segment predicts feed-forward input on the next time step.
 	bool GetIsSequence() {return IsSequence;}
@@ -108,16 +189,11 @@ public:
 	/// Methods
 
 	/// Initializes a new instance of the Segment class.
+	/// parentCell: The Cell that this segment belongs to, or NULL for a proximal segment.
+	/// epoch: The owning Region's count of time steps (see Region::GetEpochCounter()).
 	/// activeThreshold: A threshold number of active synapses between 
 	/// active and non-active Segment state.
-	void Initialize(int creationTime, float activeThreshold);
-
-	/// Advance this segment to the next time step.
-	///
-	/// The current state of this segment (active, number of synapes) will be set as 
-	/// the previous state and the current state will be reset to no cell activity by 
-	/// default until it can be determined.
-	void NextTimeStep();
+	void Initialize(Cell *parentCell, const int *epoch, int creationTime, float activeThreshold);
 
 	/// Process this segment for the current time step.
 	///
@@ -125,9 +201,24 @@ public:
 	/// step.  From there we will determine if this segment is active if enough active 
 	/// synapses are present.  This information is then cached for the remainder of the
 	/// Region's processing for the time step.  When a new time step occurs, the
-	/// Region will call nextTimeStep() on all cells/segments to cache the 
-	/// information as what was previously active.
-	void ProcessSegment();
+	/// segment's state is advanced when it is next accessed, to cache the 
+	/// information as what was previously active. The cells' states are read from 
+	/// the given Region's CellStates.Current.
+	void ProcessSegment(const unsigned char *_cellStates);
+
+	/// Record that one of this segment's input cells is active in the current time step. Returns true if it is 
+	/// the first to do so, in which case the segment is to be processed (see Cell::ActivateOutputSegments()).
+	bool Touch()
+	{
+		Refresh();
+
+		if (TouchedEpoch == StateEpoch) {
+			return false;
+		}
+
+		TouchedEpoch = StateEpoch;
+		return true;
+	}
 
 	/// Create a new proximal synapse for this segment attached to the specified 
 	/// input cell.
@@ -136,61 +227,68 @@ public:
 	/// Returns the newly created synapse.
 	ProximalSynapse *CreateProximalSynapse(SynapseParameters *params, DataSpace *inputSource, DataPoint &inputPoint, float permanence, float distanceToInput);
 
-	/// Create a new synapse for this segment attached to the specified input source.
+	/// Create a new distal synapse for this segment attached to the specified input cell, 
+	/// and add this segment to that cell's list of OutputSegments.
 	/// inputSource: the input source of the synapse to create.
 	/// initPerm: the initial permanence of the synapse.
-	/// Returns the newly created synapse.
-	DistalSynapse *CreateDistalSynapse(SynapseParameters *params, Cell *inputSource, float initPerm);
+	void CreateDistalSynapse(Cell *inputSource, float initPerm);
 
 	/// Create numSynapses new synapses attached to the specified
 	/// set of learning cells.
 	/// synapseCells: Set of available learning cells to form synapses to.
-	/// added: Set will be populated with synapses that were successfully added.
-	void CreateSynapsesToLearningCells(FastList &synapseCells, SynapseParameters *params);
+	void CreateSynapsesToLearningCells(std::vector<Cell*> &synapseCells);
+
+	/// Remove the distal synapses whose permanence has reached 0, keeping the order of the others.
+	void RemoveZeroPermanenceSynapses();
+
+	/// Remove all of this distal segment's synapses.
+	void RemoveAllDistalSynapses();
 
 	// Return a count of how many synapses on this segment are connected.
-	int GetConnectedSynapseCount() {return ConnectedSynapsesCount;}
+	int GetConnectedSynapseCount() {Refresh(); return ConnectedSynapsesCount;}
 
 	// Return a count of how many synapses on this segment were connected in the previous time step.
-	int GetPrevConnectedSynapseCount() {return PrevConnectedSynapsesCount;}
+	int GetPrevConnectedSynapseCount() {Refresh(); return PrevConnectedSynapsesCount;}
 
 	/// Return a count of how many synapses on this segment (whether connected or not) 
 	/// are active in the current time step.
-	int GetActiveSynapseCount();
+	int GetActiveSynapseCount() {Refresh(); return ActiveSynapsesCount;}
 
 	/// Return a count of how many synapses on this segment (whether connected or not) 
 	/// were active in the previous time step.
-	int GetPrevActiveSynapseCount();
+	int GetPrevActiveSynapseCount() {Refresh(); return PrevActiveSynapsesCount;}
 
 	/// Return a count of how many connected synapses on this segment are active
 	/// in the current time step.
-	int GetActiveConnectedSynapseCount() {return ActiveConnectedSynapsesCount;}
+	int GetActiveConnectedSynapseCount() {Refresh(); return ActiveConnectedSynapsesCount;}
 
 	/// Return a count of how many connected synapses on this segment 
 	/// were active in the previous time step.
-	int GetPrevActiveConnectedSynapseCount() {return PrevActiveConnectedSynapsesCount;}
+	int GetPrevActiveConnectedSynapseCount() {Refresh(); return PrevActiveConnectedSynapsesCount;}
 
 	/// Return a count of how many synapses on this segment are from active learning cells
 	/// in the current time step.
-	int GetActiveLearningSynapseCount() {return ActiveLearningSynapsesCount;}
+	int GetActiveLearningSynapseCount() {Refresh(); return ActiveLearningSynapsesCount;}
 
 	/// Return a count of how many synapses on this segment were from active learning cells
 	/// in the previous time step.
-	int GetPrevActiveLearningSynapseCount() {return PrevActiveLearningSynapsesCount;}
+	int GetPrevActiveLearningSynapseCount() {Refresh(); return PrevActiveLearningSynapsesCount;}
 	
 	// Return a count of how many synapses on this segment are connected above InitialPerm, but are not active.
-	int GetInactiveWellConnectedSynapsesCount() {return InactiveWellConnectedSynapsesCount;}
+	int GetInactiveWellConnectedSynapsesCount() {Refresh(); return InactiveWellConnectedSynapsesCount;}
 
 	/// Update all permanence values of each synapse based on current activity.
 	/// If a synapse is active, increase its permanence, else decrease it.
 	void AdaptPermanences();
 
 	/// Update (increase or decrease based on whether the synapse is active)
-	/// all permanence values of each of the synapses in the specified set.
-	void UpdatePermanences(FastList &activeSynapses);
+	/// all permanence values of each of the synapses of this distal segment.
+	/// activeCells: the input cell numbers of the active synapses.
+	/// cellMarks: a bit for each of the Region's cells, all clear (see Region::SynapseCellMarks).
+	void UpdatePermanences(const std::vector<int> &activeCells, BitArray &cellMarks);
 
 	/// Decrease the permanences of each of the synapses in the set of
 	/// active synapses that happen to be on this segment.
-	void DecreasePermanences(FastList &activeSynapses);
+	void DecreasePermanences(const std::vector<int> &activeCells, BitArray &cellMarks);
 };
 
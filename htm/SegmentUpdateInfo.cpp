@@ -16,29 +16,33 @@ SegmentUpdateInfo::~SegmentUpdateInfo(void)
 
 void SegmentUpdateInfo::Retire()
 {
-	ActiveDistalSynapses.Clear();
-	CellsThatWillLearn.Clear();
+	ActiveSynapseCells.clear();
+	CellsThatWillLearn.clear();
 }
 
 /// Randomly sample m values from the Cell array of length n (m less than n).
-/// Runs in O(2m) worst case time.  Result is written to the result
-/// array of length m containing the randomly chosen cells.
+/// Runs in O(2m) worst case time.  Result is added to CellsThatWillLearn, and
+/// the chosen cells are marked in the given chosenCells.
 /// 
 /// cells: input Cells to randomly choose from.
-/// result: the resulting random subset of Cells.
+/// chosenCells: a bit for each of the Region's cells, clear for each of the given cells.
 /// m: the number of random samples to take (m less than equal to result.Length)
-void SegmentUpdateInfo::RandomSample(FastList &cells, FastList &result, int numberRandomSamples)
+void SegmentUpdateInfo::RandomSample(std::vector<Cell*> &cells, BitArray &chosenCells, int numberRandomSamples)
 {
-	int n = cells.Count();
+	int n = (int)cells.size();
 	Cell *cell;
 	for (int i = n - numberRandomSamples; i < n; ++i)
 	{
 		int pos = rand() % (i + 1);
-		cell = (Cell*)(cells.GetByIndex(pos));
+		cell = cells[pos];
 
 		//if(subset ss contains item already) then use item[i] instead
-		bool contains = result.IsInList(cell);
-		result.InsertAtEnd(contains ? (Cell*)(cells.GetByIndex(i)) : cell);
+		if (chosenCells.Get(cell->GetNumber())) {
+			cell = cells[i];
+		}
+
+		chosenCells.Set(cell->GetNumber(), true);
+		CellsThatWillLearn.push_back(cell);
 	}
 }
 
@@ -49,16 +53,15 @@ void SegmentUpdateInfo::RandomSample(FastList &cells, FastList &result, int numb
 /// cell: cell the cell that is to have a segment added or updated.
 /// segment: the segment that is to be updated (null here means a new
 ///  segment is to be created on the parent cell).
-/// activeDistalSynapses: the set of active synapses on the segment 
-///  that are to have their permanences updated. 
+/// previous: whether the active synapses on the segment that are to have their 
+///  permanences updated are those that were active in the previous time step, 
+///  rather than those that are active in the current time step. 
 /// addNewSynapses: set to true if new synapses are to be added to the
 ///  segment (or if new segment is being created) or false if no new synapses
 ///  should be added instead only existing permanences updated. 
 ///
-void SegmentUpdateInfo::Initialize(Cell *_cell, Segment *_segment, FastList *activeDistalSynapses, bool addNewSynapses, int _creationTimeStep, UpdateType _updateType)
+void SegmentUpdateInfo::Initialize(Cell *_cell, Segment *_segment, bool previous, bool addNewSynapses, int _creationTimeStep, UpdateType _updateType)
 {
-	Cell *curCell;
-
 	// BMK Essential for temporal learning. Details specified 
 	cell = _cell;
 	segment = _segment;
@@ -67,107 +70,84 @@ void SegmentUpdateInfo::Initialize(Cell *_cell, Segment *_segment, FastList *act
 	updateType = _updateType;
 	NumPredictionSteps = 1;
 
-	if (activeDistalSynapses != NULL) {
-		activeDistalSynapses->CopyContentsTo(ActiveDistalSynapses);
+	// Record the set of active synapses on the segment that are to have their permanences updated.
+	if (segment != NULL)
+	{
+		if (previous) {
+			segment->GetPrevActiveSynapseCells(ActiveSynapseCells);
+		} else {
+			segment->GetActiveSynapseCells(ActiveSynapseCells);
+		}
 	}
 		
 	// Once synapses added, store here to visualize later
 	// this.AddedSynapses = new List<DistalSynapse>();
 
-	FastList learningCells; //capture learning cells at this time step
+	// Basic allowed number of new Synapses
+	Region *region = cell->GetColumn()->GetRegion();
+	int newSynCount = region->NewSynapsesCount;
+	if (segment != NULL)
+	{
+		newSynCount = Max(0, newSynCount - (int)ActiveSynapseCells.size());
+	}
 
 	// If adding new synapses, find the current set of learning cells within
 	// the Region and select a random subset of them to connect the segment to.
 	// Do not add >1 synapse to the same cell on a given segment
-	Region *region = cell->GetColumn()->GetRegion();
-	if (AddNewSynapses)
+	if (AddNewSynapses && (newSynCount > 0))
 	{
-		FastList segCells;
-
+		// Mark each of the segment's existing synapses' input cells, so that they will be skipped.
+		BitArray &segCells = region->SynapseCellMarks;
 		if (segment != NULL)
 		{
-			// Fill the segCells list with each of the segment's existing synapses' input cells. 
-			FastListIter synapses_iter(segment->Synapses);
-			for (Synapse *syn = (Synapse*)(synapses_iter.Reset()); syn != NULL; syn = (Synapse*)(synapses_iter.Advance()))
-			{
-				segCells.InsertAtEnd(((DistalSynapse*)syn)->GetInputSource());
+			for (int i = 0; i < (int)segment->SynapseCells.size(); i++) {
+				segCells.Set(segment->SynapseCells[i], true);
 			}
 		}
 
 		// Only allow connecting to Columns within prediction radius
 		Column *cellColumn = cell->GetColumn();
-
-		int minY, maxY, minX, maxX;
+		Area predictionArea;
 
 		// Determine bounds of Columns that we may make synapses with, those within the PredictionRadius.
 		// If prediction radius is -1, it means 'no restriction'
 		if (region->PredictionRadius > -1)
 		{
-			Area predictionArea = cellColumn->DetermineColumnsWithinHypercolumnRadius(region->PredictionRadius);
-			minX = predictionArea.MinX;
-			minY = predictionArea.MinY;
-			maxX = predictionArea.MaxX;
-			maxY = predictionArea.MaxY;
+			predictionArea = cellColumn->DetermineColumnsWithinHypercolumnRadius(region->PredictionRadius);
 		}
 		else
 		{
-			minY = 0;
-			maxY = region->Height - 1;
-			minX = 0;
-			maxX = region->Width - 1;
+			predictionArea = Area(0, 0, region->Width - 1, region->Height - 1);
 		}
 
-		for (int x = minX; x <= maxX; x++)
-		{
-			for (int y = minY; y <= maxY; y++)
-			{
-				// Get the current column at position x,y.
-				Column *col = region->GetColumn(x, y);
-
-				// NOTE: There is no indication in the Numenta pseudocode that a cell shouldn't be able to have a 
-				// distal synapse from another cell in the same column. Therefore the below check is commented out.
-				//// Skip cells in our own col (don't connect to ourself)
-				//if (col == cell->GetColumn()) {
-				//	continue;
-				//}
-
-				// Add each of the col's cells that WasLearning, and that is not in the segCells list, to the learningCells list.
-				for (int cellIndex = 0; cellIndex < region->GetCellsPerCol(); cellIndex++)
-				{
-					curCell = col->Cells[cellIndex];
-
-					if (curCell->GetWasLearning() && (!segCells.IsInList(curCell))) {
-						learningCells.InsertAtEnd(curCell);
-					}
-				}
-			}
-		}
+		// NOTE: There is no indication in the Numenta pseudocode that a cell shouldn't be able to have a 
+		// distal synapse from another cell in the same column. Therefore cells in this cell's own column are included.
 
-		segCells.Clear();
-	}
+		// Capture the cells within the prediction area that WasLearning, and that are not among the segCells.
+		std::vector<Cell*> &learningCells = region->SynapseCandidates;
+		learningCells.clear();
+		region->GetPrevLearningCells(predictionArea, segCells, learningCells);
 
-	// Basic allowed number of new Synapses
-	// TODO: Move this up so that if newSynCount is 0, the above compiling of a list of learning cells won't be done.
-	int newSynCount = region->NewSynapsesCount;
-	if (segment != NULL)
-	{
-		newSynCount = Max(0, newSynCount - ((activeDistalSynapses == NULL) ? 0 : activeDistalSynapses->Count()));
-	}
+		// Clamp at -- of learn cells
+		newSynCount = Min((int)learningCells.size(), newSynCount);
 
-	int numberLearningCells = learningCells.Count();
+		// Randomly choose synCount learning cells to add connections to
+		if (newSynCount > 0) {
+			RandomSample(learningCells, segCells, newSynCount);
+		}
 
-	// Clamp at -- of learn cells
-	newSynCount = Min(numberLearningCells, newSynCount);
+		// Clear the marks of the segment's cells and of the chosen cells.
+		if (segment != NULL)
+		{
+			for (int i = 0; i < (int)segment->SynapseCells.size(); i++) {
+				segCells.Set(segment->SynapseCells[i], false);
+			}
+		}
 
-	// Randomly choose synCount learning cells to add connections to
-	if ((numberLearningCells > 0) && (newSynCount > 0))
-	{
-		FastList result;
-		RandomSample(learningCells, result, newSynCount);
-		result.TransferContentsTo(CellsThatWillLearn);
+		for (int i = 0; i < (int)CellsThatWillLearn.size(); i++) {
+			segCells.Set(CellsThatWillLearn[i]->GetNumber(), false);
+		}
 	}
-
-	learningCells.Clear();
 }
 
 /// Create a new segment on the update cell using connections from
@@ -182,7 +162,7 @@ Segment *SegmentUpdateInfo::CreateCellSegment(int time)
 
 /// Create new synapse connections to the segment to be updated using
 /// the set of learning cells in this update info.
-void SegmentUpdateInfo::CreateSynapsesToLearningCells(SynapseParameters *params)
+void SegmentUpdateInfo::CreateSynapsesToLearningCells()
 {
-	segment->CreateSynapsesToLearningCells(CellsThatWillLearn, params);
+	segment->CreateSynapsesToLearningCells(CellsThatWillLearn);
 }
\ No newline at end of file
@@ -1,10 +1,11 @@
 #pragma once
 #include "MemObject.h"
 #include "FastList.h"
+#include "BitArray.h"
+#include <vector>
 
 class Cell;
 class Segment;
-class SynapseParameters;
 
 enum UpdateType 
 {
@@ -47,8 +48,12 @@ public:
 	bool AddNewSynapses;
 	int NumPredictionSteps, CreationTimeStep;
 	UpdateType updateType;
-	FastList ActiveDistalSynapses;
-	FastList CellsThatWillLearn;
+
+	// The input cell numbers of the active synapses whose permanences are to be updated, and the learning cells that 
+	// new synapses are to be formed from. These are kept in vectors, whose storage is retained while this pooled object
+	// is retired and reused, so that once the pool is warmed up, queueing a segment update doesn't allocate.
+	std::vector<int> ActiveSynapseCells;
+	std::vector<Cell*> CellsThatWillLearn;
 
 	Cell *GetCell() {return cell;}
 	void SetCell(Cell *value) {cell = value;}
@@ -69,13 +74,13 @@ public:
 	/// Methods
 
 	/// Randomly sample m values from the Cell array of length n (m less than n).
-	/// Runs in O(2m) worst case time.  Result is written to the result
-	/// array of length m containing the randomly chosen cells.
+	/// Runs in O(2m) worst case time.  Result is added to CellsThatWillLearn, and
+	/// the chosen cells are marked in the given chosenCells.
 	/// 
 	/// cells: input Cells to randomly choose from.
-	/// result: the resulting random subset of Cells.
+	/// chosenCells: a bit for each of the Region's cells, clear for each of the given cells.
 	/// m: the number of random samples to take (m less than equal to result.Length)
-	void RandomSample(FastList &cells, FastList &result, int m);
+	void RandomSample(std::vector<Cell*> &cells, BitArray &chosenCells, int m);
 
 	///Create a new SegmentUpdateInfo that is to modify the state of the Region
 	///either by adding a new segment to a cell, new synapses to a segment,
@@ -84,13 +89,14 @@ public:
 	/// cell: cell the cell that is to have a segment added or updated.
 	/// segment: the segment that is to be updated (null here means a new
 	///  segment is to be created on the parent cell).
-	/// activeDistalSynapses: the set of active synapses on the segment 
-	///  that are to have their permanences updated. 
+	/// previous: whether the active synapses on the segment that are to have their 
+	///  permanences updated are those that were active in the previous time step, 
+	///  rather than those that are active in the current time step. 
 	/// addNewSynapses: set to true if new synapses are to be added to the
 	///  segment (or if new segment is being created) or false if no new synapses
 	///  should be added instead only existing permanences updated. 
 	///
-	void Initialize(Cell *_cell, Segment *_segment, FastList *activeDistalSynapses, bool addNewSynapses, int _creationTimeStep, UpdateType _updateType);
+	void Initialize(Cell *_cell, Segment *_segment, bool previous, bool addNewSynapses, int _creationTimeStep, UpdateType _updateType);
 
 	/// Create a new segment on the update cell using connections from
 	/// the set of learning cells for the update info.
@@ -98,6 +104,6 @@ public:
 
 	/// Create new synapse connections to the segment to be updated using
 	/// the set of learning cells in this update info.
-	void CreateSynapsesToLearningCells(SynapseParameters *params);
+	void CreateSynapsesToLearningCells();
 };
 
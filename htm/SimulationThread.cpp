@@ -0,0 +1,123 @@
+#include "SimulationThread.h"
+#include "NetworkManager.h"
+
+SimulationThread::SimulationThread(NetworkManager *_networkManager)
+	: networkManager(_networkManager)
+{
+	captureSnapshot = &snapshots[0];
+	publishedSnapshot = &snapshots[1];
+	displaySnapshot = &snapshots[2];
+	snapshotPublished = false;
+	stopRequested.store(0);
+	stopTime.store(0);
+}
+
+SimulationThread::~SimulationThread()
+{
+	StopRunning();
+}
+
+/// Rebuild the snapshots to match the network's current InputSpaces and Regions. Must only be
+/// called while not running.
+void SimulationThread::ResetSnapshots()
+{
+	for (int i = 0; i < 3; i++)
+	{
+		snapshots[i].Clear();
+
+		for (std::vector<InputSpace*>::const_iterator input_iter = networkManager->inputSpaces.begin(), end = networkManager->inputSpaces.end(); input_iter != end; ++input_iter) {
+			snapshots[i].AddDataSpace(*input_iter);
+		}
+
+		for (std::vector<Region*>::const_iterator region_iter = networkManager->regions.begin(), end = networkManager->regions.end(); region_iter != end; ++region_iter) {
+			snapshots[i].AddDataSpace(*region_iter);
+		}
+	}
+
+	snapshotPublished = false;
+
+	// Fill the displayed snapshot with the network's current state.
+	PublishSnapshot();
+	AcquireSnapshot();
+}
+
+/// Begin running time steps, until StopRunning() is called or the stop time is reached.
+void SimulationThread::StartRunning()
+{
+	if (isRunning()) {
+		return;
+	}
+
+	stopRequested.store(0);
+	start();
+}
+
+/// Stop running time steps, and wait for the current step to finish.
+void SimulationThread::StopRunning()
+{
+	stopRequested.store(1);
+	wait();
+}
+
+/// Capture the network's current state and publish it. Called by the simulation thread while
+/// running, or by the UI thread while not running.
+void SimulationThread::PublishSnapshot()
+{
+	// Capture into the snapshot that neither the UI nor the published slot refers to.
+	captureSnapshot->Capture(networkManager->GetTime());
+
+	// Swap it into the published slot.
+	snapshotMutex.lock();
+	NetworkSnapshot *temp = publishedSnapshot;
+	publishedSnapshot = captureSnapshot;
+	captureSnapshot = temp;
+	snapshotPublished = true;
+	snapshotMutex.unlock();
+}
+
+/// If a snapshot has been published since the last call, make it the displayed snapshot.
+/// returns: true if the displayed snapshot has changed.
+bool SimulationThread::AcquireSnapshot()
+{
+	QMutexLocker locker(&snapshotMutex);
+
+	if (!snapshotPublished) {
+		return false;
+	}
+
+	NetworkSnapshot *temp = displaySnapshot;
+	displaySnapshot = publishedSnapshot;
+	publishedSnapshot = temp;
+	snapshotPublished = false;
+
+	return true;
+}
+
+void SimulationThread::run()
+{
+	bool publishNeeded;
+
+	while (stopRequested.load() == 0)
+	{
+		// Execute one step for the network.
+		networkManager->Step();
+
+		// If the current time is the stop time, stop running.
+		if (networkManager->GetTime() == stopTime.load()) {
+			break;
+		}
+
+		// Only capture a new snapshot once the UI has taken the previous one, so that no time is
+		// spent capturing snapshots that will never be displayed.
+		snapshotMutex.lock();
+		publishNeeded = !snapshotPublished;
+		snapshotMutex.unlock();
+
+		if (publishNeeded) {
+			PublishSnapshot();
+		}
+	}
+
+	// Publish the final state.
+	PublishSnapshot();
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <QtCore/QThread>
+#include <QtCore/QMutex>
+#include <QtCore/QAtomicInt>
+#include "ActivitySnapshot.h"
+
+class NetworkManager;
+
+/// Runs the network's time steps on a thread of its own, so that the speed of the simulation
+/// does not depend on how long the UI takes to paint.
+///
+/// While running, the network must not be read by any other thread. Instead, the state needed for
+/// display is published as a NetworkSnapshot. Three snapshots are kept: one being captured by the
+/// simulation thread, one holding the most recently published state, and one being displayed by
+/// the UI. The UI swaps in the newest snapshot with AcquireSnapshot(); neither thread ever waits
+/// for the other to finish capturing or painting.
+class SimulationThread : public QThread
+{
+public:
+	SimulationThread(NetworkManager *_networkManager);
+	~SimulationThread();
+
+	/// Rebuild the snapshots to match the network's current InputSpaces and Regions. Must only be
+	/// called while not running.
+	void ResetSnapshots();
+
+	/// Begin running time steps, until StopRunning() is called or the stop time is reached.
+	void StartRunning();
+
+	/// Stop running time steps, and wait for the current step to finish.
+	void StopRunning();
+
+	/// Set the time at which to stop running (0 for no stop time).
+	void SetStopTime(int _stopTime) {stopTime.store(_stopTime);}
+
+	/// Capture the network's current state and publish it. Called by the simulation thread while
+	/// running, or by the UI thread while not running.
+	void PublishSnapshot();
+
+	/// If a snapshot has been published since the last call, make it the displayed snapshot.
+	/// returns: true if the displayed snapshot has changed.
+	bool AcquireSnapshot();
+
+	/// Returns the snapshot currently being displayed. It is only changed by AcquireSnapshot().
+	NetworkSnapshot *GetSnapshot() {return displaySnapshot;}
+
+protected:
+	void run();
+
+private:
+	NetworkManager *networkManager;
+
+	NetworkSnapshot snapshots[3];
+	NetworkSnapshot *captureSnapshot, *publishedSnapshot, *displaySnapshot;
+	bool snapshotPublished;
+	QMutex snapshotMutex;
+
+	QAtomicInt stopRequested, stopTime;
+};
@@ -0,0 +1,172 @@
+#include "Statistic.h"
+#include "Region.h"
+#include "Cell.h"
+
+// Statistic
+
+Statistic::Statistic(const std::string &_id, int _numValues, int _sampleInterval, int _columnInterval, int _reportInterval)
+	: id(_id), numValues(_numValues), sampleInterval(_sampleInterval), columnInterval(_columnInterval), reportInterval(_reportInterval), maxHistory(STATISTIC_DEFAULT_MAX_HISTORY)
+{
+	Reset();
+}
+
+/// Called by the Region at the end of each of its time steps. Takes a sample if one is due, and
+/// records the values accumulated so far if a report is due.
+void Statistic::Step(Region *_region)
+{
+	int time = _region->GetStepCounter();
+
+	if (sampleInterval <= 0) {
+		return;
+	}
+
+	if ((time % sampleInterval) == 0)
+	{
+		// Examine a different subset of the columns on each sample, so that all are examined in turn.
+		int interval = (columnInterval > 1) ? columnInterval : 1;
+		Sample(_region, totalSamples % interval);
+		numSamples++;
+		totalSamples++;
+	}
+
+	// A report is due on its own interval, whether or not a sample was taken at this time step.
+	if ((reportInterval <= 0) || ((time % reportInterval) != 0)) {
+		return;
+	}
+
+	// Record the average of each value over the report interval's samples, and begin the next interval.
+	StatisticRecord record;
+	record.time = time;
+	record.numSamples = numSamples;
+	record.values.resize(numValues);
+	for (int valueIndex = 0; valueIndex < numValues; valueIndex++)
+	{
+		record.values[valueIndex] = (counts[valueIndex] > 0.0) ? (float)(sums[valueIndex] / counts[valueIndex]) : 0.0f;
+		sums[valueIndex] = 0.0;
+		counts[valueIndex] = 0.0;
+	}
+
+	history.push_back(record);
+	while ((int)history.size() > maxHistory) {
+		history.pop_front();
+	}
+
+	numSamples = 0;
+}
+
+/// Discard the values accumulated so far, and the history.
+void Statistic::Reset()
+{
+	sums.assign(numValues, 0.0);
+	counts.assign(numValues, 0.0);
+	numSamples = 0;
+	totalSamples = 0;
+	history.clear();
+}
+
+// FeatureAccuracyStatistic
+
+const char *FeatureAccuracyStatistic::GetValueName(int _valueIndex)
+{
+	return (_valueIndex == 0) ? "Missing synapses" : "Extra synapses";
+}
+
+void FeatureAccuracyStatistic::Sample(Region *_region, int _firstColIndex)
+{
+	Column *col;
+	int interval = Max(1, GetColumnInterval());
+
+	for (int ColIndex = _firstColIndex; ColIndex < _region->Width * _region->Height; ColIndex += interval)
+	{
+		col = _region->Columns[ColIndex];
+
+		if (col->GetIsActive() == false) {
+			continue;
+		}
+
+		for (int synIndex = 0; synIndex < col->NumProximalSynapses; synIndex++)
+		{
+			bool active = col->ProximalInputBits[synIndex]->Get(col->ProximalInputValues[synIndex]);
+
+			if (active && (col->ProximalConnected[synIndex] == 0)) {
+				sums[0]++;
+			}
+			else if ((active == false) && col->ProximalConnected[synIndex]) {
+				sums[1]++;
+			}
+		}
+
+		counts[0]++;
+		counts[1]++;
+	}
+}
+
+// SparsityStatistic
+
+const char *SparsityStatistic::GetValueName(int _valueIndex)
+{
+	return (_valueIndex == 0) ? "Active columns" : "Active cells";
+}
+
+void SparsityStatistic::Sample(Region *_region, int _firstColIndex)
+{
+	Column *col;
+	int interval = Max(1, GetColumnInterval());
+
+	for (int ColIndex = _firstColIndex; ColIndex < _region->Width * _region->Height; ColIndex += interval)
+	{
+		col = _region->Columns[ColIndex];
+
+		sums[0] += col->GetIsActive() ? 1 : 0;
+		counts[0]++;
+
+		for (int cellIndex = 0; cellIndex < _region->GetCellsPerCol(); cellIndex++) {
+			sums[1] += col->Cells[cellIndex]->GetIsActive() ? 1 : 0;
+		}
+		counts[1] += _region->GetCellsPerCol();
+	}
+}
+
+// PredictionHitRateStatistic
+
+const char *PredictionHitRateStatistic::GetValueName(int _valueIndex)
+{
+	return (_valueIndex == 0) ? "Hit rate" : "Precision";
+}
+
+void PredictionHitRateStatistic::Sample(Region *_region, int _firstColIndex)
+{
+	Column *col;
+	Cell *cell;
+	bool predicted;
+	int interval = Max(1, GetColumnInterval());
+
+	for (int ColIndex = _firstColIndex; ColIndex < _region->Width * _region->Height; ColIndex += interval)
+	{
+		col = _region->Columns[ColIndex];
+
+		// Determine whether any of the column's cells was predicting, during the previous time step, activation in this one.
+		predicted = false;
+		for (int cellIndex = 0; cellIndex < _region->GetCellsPerCol(); cellIndex++)
+		{
+			cell = col->Cells[cellIndex];
+			if (cell->GetWasPredicted() && (cell->GetPrevNumPredictionSteps() == 1))
+			{
+				predicted = true;
+				break;
+			}
+		}
+
+		if (col->GetIsActive())
+		{
+			sums[0] += predicted ? 1 : 0;
+			counts[0]++;
+		}
+
+		if (predicted)
+		{
+			sums[1] += col->GetIsActive() ? 1 : 0;
+			counts[1]++;
+		}
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <deque>
+#include <vector>
+#include <string>
+
+class Region;
+
+// The default number of records kept in each Statistic's history.
+const int STATISTIC_DEFAULT_MAX_HISTORY = 1000;
+
+/// One record of a Statistic: each of its values, averaged over the samples taken during a report interval.
+struct StatisticRecord
+{
+	// The time step at the end of the report interval, and the number of samples taken during it.
+	int time, numSamples;
+
+	std::vector<float> values;
+};
+
+/// A measure of a Region's activity, taken on sampled time steps and kept in memory.
+///
+/// A Statistic is sampled every SampleInterval time steps, or never if SampleInterval is 0. A Statistic that
+/// examines the Region's columns examines only one in every ColumnInterval of them on each sample, starting
+/// from a different column each time so that every column is examined in turn. Every ReportInterval time
+/// steps, the values accumulated from the samples are appended to the Statistic's history as a record,
+/// which keeps only the most recent MaxHistory records.
+///
+/// Each of a Statistic's values is a ratio, accumulated as a sum and a count over all of a report interval's
+/// samples (for example, missing synapses per active column), so that every sample is weighted by how much
+/// it counted. New kinds of Statistic are added by implementing Sample() and GetValueName(), and passing
+/// an instance to Region::AddStatistic().
+class Statistic
+{
+public:
+	Statistic(const std::string &_id, int _numValues, int _sampleInterval, int _columnInterval, int _reportInterval);
+	virtual ~Statistic() {}
+
+	const std::string &GetID() {return id;}
+
+	int GetNumValues() {return numValues;}
+
+	/// Returns the name of the given value, for reporting.
+	virtual const char *GetValueName(int _valueIndex) = 0;
+
+	void SetSampleInterval(int _sampleInterval) {sampleInterval = _sampleInterval;}
+	int GetSampleInterval() {return sampleInterval;}
+	void SetColumnInterval(int _columnInterval) {columnInterval = _columnInterval;}
+	int GetColumnInterval() {return columnInterval;}
+	void SetReportInterval(int _reportInterval) {reportInterval = _reportInterval;}
+	int GetReportInterval() {return reportInterval;}
+	void SetMaxHistory(int _maxHistory) {maxHistory = _maxHistory;}
+	int GetMaxHistory() {return maxHistory;}
+
+	bool IsEnabled() {return sampleInterval > 0;}
+
+	/// Called by the Region at the end of each of its time steps. Takes a sample if one is due, and
+	/// records the values accumulated so far if a report is due.
+	void Step(Region *_region);
+
+	/// Returns the records kept so far, oldest first.
+	const std::deque<StatisticRecord> &GetHistory() {return history;}
+
+	/// Discard the values accumulated so far, and the history.
+	void Reset();
+
+protected:
+
+	/// Measure the given Region during its current time step, adding to sums and counts. Only the columns
+	/// with indices _firstColIndex, _firstColIndex + ColumnInterval, ... are to be examined.
+	virtual void Sample(Region *_region, int _firstColIndex) = 0;
+
+	// The sum and count of each value, accumulated since the last report.
+	std::vector<double> sums, counts;
+
+private:
+
+	std::string id;
+	int numValues, sampleInterval, columnInterval, reportInterval, maxHistory;
+
+	// The number of samples taken since the last report, and in total.
+	int numSamples, totalSamples;
+
+	std::deque<StatisticRecord> history;
+};
+
+/// How well each active column's connected proximal synapses match its input: the number of active
+/// inputs without a connected synapse ("missing"), and of connected synapses with an inactive input
+/// ("extra"), per active column. This visits every proximal synapse of each examined column.
+class FeatureAccuracyStatistic : public Statistic
+{
+public:
+	FeatureAccuracyStatistic(int _sampleInterval, int _columnInterval, int _reportInterval) : Statistic("FeatureAccuracy", 2, _sampleInterval, _columnInterval, _reportInterval) {}
+
+	const char *GetValueName(int _valueIndex);
+
+protected:
+	void Sample(Region *_region, int _firstColIndex);
+};
+
+/// The fraction of columns that are active, and of cells that are active.
+class SparsityStatistic : public Statistic
+{
+public:
+	SparsityStatistic(int _sampleInterval, int _columnInterval, int _reportInterval) : Statistic("Sparsity", 2, _sampleInterval, _columnInterval, _reportInterval) {}
+
+	const char *GetValueName(int _valueIndex);
+
+protected:
+	void Sample(Region *_region, int _firstColIndex);
+};
+
+/// How well the temporal pooler predicts column activity: the fraction of active columns that had a cell
+/// predicting activation in the next time step, as of the previous time step ("hit rate"), and the fraction
+/// of columns with such a cell that did become active ("precision").
+class PredictionHitRateStatistic : public Statistic
+{
+public:
+	PredictionHitRateStatistic(int _sampleInterval, int _columnInterval, int _reportInterval) : Statistic("PredictionHitRate", 2, _sampleInterval, _columnInterval, _reportInterval) {}
+
+	const char *GetValueName(int _valueIndex);
+
+protected:
+	void Sample(Region *_region, int _firstColIndex);
+};
@@ -0,0 +1,168 @@
+#include <math.h>
+#include "StepProfiler.h"
+#include "Timer.h"
+
+// LatencyHistogram
+
+LatencyHistogram::LatencyHistogram()
+{
+	Reset();
+}
+
+void LatencyHistogram::Reset()
+{
+	for (int i = 0; i < LATENCY_HISTOGRAM_NUM_BUCKETS; i++) {
+		buckets[i] = 0;
+	}
+
+	count = 0;
+	totalTicks = 0;
+	maxTicks = 0;
+}
+
+/// Record a single latency, given in timer ticks.
+void LatencyHistogram::Record(long long _ticks)
+{
+	double seconds = TimerTicksToSeconds(_ticks);
+	int bucket = 0;
+
+	if (seconds > LATENCY_HISTOGRAM_MIN_SECONDS)
+	{
+		bucket = (int)(log(seconds / LATENCY_HISTOGRAM_MIN_SECONDS) * (LATENCY_BUCKETS_PER_OCTAVE / log(2.0))) + 1;
+		if (bucket >= LATENCY_HISTOGRAM_NUM_BUCKETS) {
+			bucket = LATENCY_HISTOGRAM_NUM_BUCKETS - 1;
+		}
+	}
+
+	buckets[bucket]++;
+	count++;
+	totalTicks += _ticks;
+
+	if (_ticks > maxTicks) {
+		maxTicks = _ticks;
+	}
+}
+
+/// Returns the latency, in seconds, below which the given percentage (0 to 100) of recorded latencies fall.
+///
+/// The upper bound of the bucket containing the requested percentile is returned, limited to the
+/// maximum recorded latency.
+double LatencyHistogram::GetPercentile(float _percentile)
+{
+	if (count == 0) {
+		return 0.0;
+	}
+
+	// Determine how many recorded latencies must fall at or below the result.
+	int target = (int)ceil((double)count * _percentile / 100.0);
+	if (target < 1) {
+		target = 1;
+	}
+
+	int bucket, cumulative = 0;
+	for (bucket = 0; bucket < LATENCY_HISTOGRAM_NUM_BUCKETS - 1; bucket++)
+	{
+		cumulative += buckets[bucket];
+		if (cumulative >= target) {
+			break;
+		}
+	}
+
+	double upperBound = LATENCY_HISTOGRAM_MIN_SECONDS * pow(2.0, (double)bucket / (double)LATENCY_BUCKETS_PER_OCTAVE);
+	double max = GetMax();
+
+	return (upperBound < max) ? upperBound : max;
+}
+
+double LatencyHistogram::GetMean()
+{
+	return (count == 0) ? 0.0 : (TimerTicksToSeconds(totalTicks) / (double)count);
+}
+
+double LatencyHistogram::GetMax()
+{
+	return TimerTicksToSeconds(maxTicks);
+}
+
+// StepProfiler
+
+StepProfiler::StepProfiler()
+{
+	Reset();
+}
+
+/// Discard all recorded timings.
+void StepProfiler::Reset()
+{
+	for (int phase = 0; phase < NUM_STEP_PHASES; phase++)
+	{
+		phaseTicks[phase] = 0;
+		curStepPhaseTicks[phase] = 0;
+		phaseHistograms[phase].Reset();
+	}
+
+	stepHistogram.Reset();
+	numSteps = 0;
+}
+
+/// Record the time from _startTicks until now as having been spent in the given phase of the current step.
+/// returns: The current tick count, to be passed as the _startTicks of the following phase.
+long long StepProfiler::EndPhase(StepPhaseEnum _phase, long long _startTicks)
+{
+	long long endTicks = GetTimerTicks();
+	curStepPhaseTicks[_phase] += (endTicks - _startTicks);
+	return endTicks;
+}
+
+/// Record the latencies of the step that has just been completed.
+void StepProfiler::EndStep()
+{
+	long long stepTicks = 0;
+
+	for (int phase = 0; phase < NUM_STEP_PHASES; phase++)
+	{
+		phaseTicks[phase] += curStepPhaseTicks[phase];
+		phaseHistograms[phase].Record(curStepPhaseTicks[phase]);
+		stepTicks += curStepPhaseTicks[phase];
+		curStepPhaseTicks[phase] = 0;
+	}
+
+	stepHistogram.Record(stepTicks);
+	numSteps++;
+}
+
+/// Returns the total time, in seconds, spent in the given phase since the last Reset().
+double StepProfiler::GetPhaseTime(StepPhaseEnum _phase)
+{
+	return TimerTicksToSeconds(phaseTicks[_phase]);
+}
+
+/// Returns the total time, in seconds, spent in all phases since the last Reset().
+double StepProfiler::GetTotalTime()
+{
+	long long totalTicks = 0;
+
+	for (int phase = 0; phase < NUM_STEP_PHASES; phase++) {
+		totalTicks += phaseTicks[phase];
+	}
+
+	return TimerTicksToSeconds(totalTicks);
+}
+
+/// Returns the name of the given step phase, for reporting.
+const char *StepProfiler::GetPhaseName(StepPhaseEnum _phase)
+{
+	switch (_phase)
+	{
+		case STEP_PHASE_NEXT_TIME_STEP: return "NextTimeStep";
+		case STEP_PHASE_SP_OVERLAP: return "SP Overlap";
+		case STEP_PHASE_SP_INHIBITION: return "SP Inhibition";
+		case STEP_PHASE_SP_LEARNING: return "SP Learning/Boosting";
+		case STEP_PHASE_SP_RADIUS_UPDATE: return "SP Radius Update";
+		case STEP_PHASE_TP_ACTIVE_STATE: return "TP Active State";
+		case STEP_PHASE_TP_PREDICTIVE_STATE: return "TP Predictive State";
+		case STEP_PHASE_TP_SEGMENT_UPDATES: return "TP Segment Updates";
+		case STEP_PHASE_STATISTICS: return "Statistics";
+		default: return "Unknown";
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// The phases of a Region's time step, each of which is timed separately.
+enum StepPhaseEnum
+{
+	STEP_PHASE_NEXT_TIME_STEP = 0,
+	STEP_PHASE_SP_OVERLAP = 1,
+	STEP_PHASE_SP_INHIBITION = 2,
+	STEP_PHASE_SP_LEARNING = 3,
+	STEP_PHASE_SP_RADIUS_UPDATE = 4,
+	STEP_PHASE_TP_ACTIVE_STATE = 5,
+	STEP_PHASE_TP_PREDICTIVE_STATE = 6,
+	STEP_PHASE_TP_SEGMENT_UPDATES = 7,
+	STEP_PHASE_STATISTICS = 8,
+	NUM_STEP_PHASES = 9
+};
+
+// Latency histogram buckets are spaced logarithmically, LATENCY_BUCKETS_PER_OCTAVE buckets per
+// doubling of latency, starting from LATENCY_HISTOGRAM_MIN_SECONDS. This covers 100ns to several minutes,
+// with a worst case error of about 9%.
+const int LATENCY_BUCKETS_PER_OCTAVE = 8;
+const int LATENCY_HISTOGRAM_NUM_BUCKETS = 256;
+const double LATENCY_HISTOGRAM_MIN_SECONDS = 0.0000001;
+
+/// Records a distribution of latencies, from which percentiles can be read.
+class LatencyHistogram
+{
+public:
+	LatencyHistogram();
+
+	void Reset();
+
+	/// Record a single latency, given in timer ticks.
+	void Record(long long _ticks);
+
+	int GetCount() {return count;}
+
+	/// Returns the latency, in seconds, below which the given percentage (0 to 100) of recorded latencies fall.
+	double GetPercentile(float _percentile);
+
+	/// Returns the mean and maximum recorded latencies, in seconds.
+	double GetMean();
+	double GetMax();
+
+private:
+	int buckets[LATENCY_HISTOGRAM_NUM_BUCKETS];
+	int count;
+	long long totalTicks, maxTicks;
+};
+
+/// Accumulates the time spent in each phase of a Region's time steps, along with the
+/// distribution of latencies of each phase and of the step as a whole.
+///
+/// During a step, each phase is ended by calling EndPhase() with the tick count at which the phase
+/// began; it returns the tick count at which the next phase begins. EndStep() is then called to
+/// record the step's latencies.
+class StepProfiler
+{
+public:
+	StepProfiler();
+
+	/// Discard all recorded timings.
+	void Reset();
+
+	/// Record the time from _startTicks until now as having been spent in the given phase of the current step.
+	/// returns: The current tick count, to be passed as the _startTicks of the following phase.
+	long long EndPhase(StepPhaseEnum _phase, long long _startTicks);
+
+	/// Record the latencies of the step that has just been completed.
+	void EndStep();
+
+	/// Returns the number of steps recorded since the last Reset().
+	int GetNumSteps() {return numSteps;}
+
+	/// Returns the total time, in seconds, spent in the given phase since the last Reset().
+	double GetPhaseTime(StepPhaseEnum _phase);
+
+	/// Returns the total time, in seconds, spent in all phases since the last Reset().
+	double GetTotalTime();
+
+	LatencyHistogram &GetPhaseHistogram(StepPhaseEnum _phase) {return phaseHistograms[_phase];}
+	LatencyHistogram &GetStepHistogram() {return stepHistogram;}
+
+	/// Returns the name of the given step phase, for reporting.
+	static const char *GetPhaseName(StepPhaseEnum _phase);
+
+private:
+	long long phaseTicks[NUM_STEP_PHASES], curStepPhaseTicks[NUM_STEP_PHASES];
+	LatencyHistogram phaseHistograms[NUM_STEP_PHASES];
+	LatencyHistogram stepHistogram;
+	int numSteps;
+};
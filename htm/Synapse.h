@@ -1,5 +1,16 @@
 #pragma once
 #include "FastList.h"
+#include "Utils.h"
+#include <math.h>
+
+/// The formats in which synapse permanences may be stored: as floats, or as fixed point values
+/// with 65535 or 255 steps between 0 and 1.
+enum PermanenceFormat
+{
+	PERMANENCE_FORMAT_FLOAT,
+	PERMANENCE_FORMAT_16BIT,
+	PERMANENCE_FORMAT_8BIT
+};
 
 class SynapseParameters
 {
@@ -16,15 +27,61 @@ public:
 	/// Amount permanences of synapses are incremented in learning.
 	float PermanenceInc;
 
+	/// The format in which permanences are stored. Defaults to PERMANENCE_FORMAT_FLOAT.
+	PermanenceFormat Format;
+
 	SynapseParameters()
 	{
 		ConnectedPerm = 0.2f;
 		InitialPermanence = ConnectedPerm + 0.1f;
 		PermanenceDec = 0.015f;
 		PermanenceInc = 0.015f;
+		Format = PERMANENCE_FORMAT_FLOAT;
+	}
+
+	/// Set the format in which permanences are stored, and round the permanence values and amounts
+	/// to whole fixed point steps (an amount being at least one step), so that learning stays on those steps.
+	void SetFormat(PermanenceFormat _format)
+	{
+		Format = _format;
+		ConnectedPerm = QuantizePermanence(ConnectedPerm);
+		InitialPermanence = QuantizePermanence(InitialPermanence);
+		PermanenceDec = QuantizePermanenceAmount(PermanenceDec);
+		PermanenceInc = QuantizePermanenceAmount(PermanenceInc);
+	}
+
+	/// The number of fixed point steps between permanences 0 and 1, or 0 if permanences are floats.
+	int GetPermanenceLevels() const {return (Format == PERMANENCE_FORMAT_16BIT) ? 65535 : ((Format == PERMANENCE_FORMAT_8BIT) ? 255 : 0);}
+
+	/// Returns the given permanence rounded to the nearest fixed point step, if permanences are
+	/// fixed point. Permanences outside of [0, 1] are rounded but not limited.
+	float QuantizePermanence(float _permanence) const
+	{
+		return (Format == PERMANENCE_FORMAT_FLOAT) ? _permanence : (floorf((_permanence * GetPermanenceLevels()) + 0.5f) / (float)GetPermanenceLevels());
+	}
+
+	/// Returns the given amount of change in permanence rounded to a whole number of fixed point steps,
+	/// at least one, if permanences are fixed point.
+	float QuantizePermanenceAmount(float _amount) const
+	{
+		return (Format == PERMANENCE_FORMAT_FLOAT) ? _amount : (Max(1.0f, floorf((_amount * GetPermanenceLevels()) + 0.5f)) / (float)GetPermanenceLevels());
 	}
+
+	/// Convert between a permanence, limited to [0, 1], and its fixed point value.
+	int PermanenceToUnits(float _permanence) const {return (int)floorf((Min(1.0f, Max(0.0f, _permanence)) * GetPermanenceLevels()) + 0.5f);}
+	float UnitsToPermanence(int _units) const {return (float)_units / (float)GetPermanenceLevels();}
 };
 
+// Arrays of permanences may be stored as floats or as fixed point values (see PermanenceFormat). Operations
+// on them are written as templates over the stored type, with the parameters converted to that type by 
+// StoredPermanence(). Sums are taken in PermanenceSum<T>::Type, so that fixed point values can't overflow.
+
+template <class T> struct PermanenceSum {typedef int Type;};
+template <> struct PermanenceSum<float> {typedef float Type;};
+
+template <class T> inline T StoredPermanence(const SynapseParameters &_params, float _permanence) {return (T)(_params.PermanenceToUnits(_permanence));}
+template <> inline float StoredPermanence<float>(const SynapseParameters &_params, float _permanence) {return _permanence;}
+
 /// A data structure representing a synapse. Contains a permanence value to
 /// indicate connectivity to a target cell.  
 class Synapse
@@ -57,9 +114,10 @@ public:
 		return IsConnected;
 	}
 
-	/// A value to indicate connectivity to a target cell.  
+	/// A value to indicate connectivity to a target cell. If permanences are fixed point, the value
+	/// is rounded to the nearest fixed point step, so that all learning takes place in whole steps.
 	float GetPermanence() {return Permanence;}
-	void  SetPermanence(float value) {Permanence = value; IsConnected = (Permanence >= Params->ConnectedPerm);}
+	void  SetPermanence(float value) {Permanence = Params->QuantizePermanence(value); IsConnected = (Permanence >= Params->ConnectedPerm);}
 
 	virtual bool GetWasActive() {return false;}
 
@@ -0,0 +1,38 @@
+#include "Timer.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <chrono>
+#endif
+
+// The system clock resolution under VS2012's std::chrono is too coarse (~1ms) to time
+// individual step phases, so QueryPerformanceCounter is used on Windows.
+
+long long GetTimerTicks()
+{
+#ifdef _WIN32
+	LARGE_INTEGER count;
+	QueryPerformanceCounter(&count);
+	return count.QuadPart;
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+double TimerTicksToSeconds(long long _ticks)
+{
+#ifdef _WIN32
+	static double ticksPerSecond = 0.0;
+	if (ticksPerSecond == 0.0)
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		ticksPerSecond = (double)(frequency.QuadPart);
+	}
+	return (double)_ticks / ticksPerSecond;
+#else
+	return (double)_ticks / 1000000000.0;
+#endif
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+/// A high resolution clock, used for timing the phases of a Region's time step.
+/// Ticks are counted from an arbitrary starting point; only differences between two
+/// readings are meaningful.
+long long GetTimerTicks();
+
+/// Convert a number of ticks (as returned by GetTimerTicks()) to seconds.
+double TimerTicksToSeconds(long long _ticks);
@@ -2,9 +2,9 @@
 #include "ColumnDisp.h"
 #include "Cell.h"
 #include "Segment.h"
-#include "DistalSynapse.h"
 #include "FastList.h"
 #include "htm.h"
+#include "ActivitySnapshot.h"
 #include <QtGui/QWheelEvent>
 #include <QtWidgets/QStyle.h>
 #include <QtWidgets/QToolButton.h>
@@ -360,6 +360,12 @@ void View::SetViewMode(bool _viewActivity, bool _viewReconstruction, bool _viewP
 		graphicsView->scene()->update(graphicsView->sceneRect());
 	}
 
+	// The selected synapses are read directly from the network, which may not be read while it is
+	// running. Keep displaying those that were found when last paused.
+	if (win->IsRunning()) {
+		return;
+	}
+
 	// Clear all existing records of selected synapses.
 	for (std::map<ColumnDisp*,ColumnDisp*>::const_iterator col_iter = cols_with_sel_synapses.begin(), end = cols_with_sel_synapses.end(); col_iter != end; ++col_iter) {
 		col_iter->first->ClearSelectedSynapses();
@@ -379,7 +385,7 @@ void View::SetViewMode(bool _viewActivity, bool _viewReconstruction, bool _viewP
 			Segment *seg;
 			FastListIter synapse_iter, seg_iter;
 			ProximalSynapse *pSyn;
-			DistalSynapse *dSyn;
+			Cell *inputCell;
 			int colX, colY, colIndex;
 
 			// Display selected proximal synapses.
@@ -395,7 +401,7 @@ void View::SetViewMode(bool _viewActivity, bool _viewReconstruction, bool _viewP
 					{
 						// Record the information for the current synapse in its column's ColumnDisp.
 						colIndex = pSyn->InputPoint.X + (pSyn->InputPoint.Y * sceneWidth);
-						columnDisps[colIndex]->SelectSynapse(pSyn, pSyn->InputPoint.Index);
+						columnDisps[colIndex]->SelectSynapse(pSyn->InputPoint.Index, pSyn->GetPermanence(), pSyn->Params->ConnectedPerm);
 
 						// Record that the current column has one or more selected synapses.
 						cols_with_sel_synapses[columnDisps[colIndex]] = columnDisps[colIndex];
@@ -426,16 +432,16 @@ void View::SetViewMode(bool _viewActivity, bool _viewReconstruction, bool _viewP
 					}
 
 					// Iterate through all synapses on the current distal segment.
-					synapse_iter.SetList(seg->Synapses);
-					for (dSyn = (DistalSynapse*)(synapse_iter.Reset()); dSyn != NULL; dSyn = (DistalSynapse*)(synapse_iter.Advance()))
+					for (int synIndex = 0; synIndex < seg->GetNumDistalSynapses(); synIndex++)
 					{
 						// Get information about this distal synapse's input cell.
-						colX = (int)(dSyn->GetInputSource()->GetColumn()->GetPosition().X);
-						colY = (int)(dSyn->GetInputSource()->GetColumn()->GetPosition().Y);
+						inputCell = seg->GetSynapseInputCell(synIndex);
+						colX = (int)(inputCell->GetColumn()->GetPosition().X);
+						colY = (int)(inputCell->GetColumn()->GetPosition().Y);
 
 						// Record the information for the current synapse in its column's ColumnDisp.
 						colIndex = colX + (colY * sceneWidth);
-						columnDisps[colIndex]->SelectSynapse(dSyn, dSyn->GetInputSource()->GetIndex());
+						columnDisps[colIndex]->SelectSynapse(inputCell->GetIndex(), seg->GetSynapsePermanence(synIndex), selRegion->DistalSynapseParams.ConnectedPerm);
 
 						// Record that the current column has one or more selected synapses.
 						cols_with_sel_synapses[columnDisps[colIndex]] = columnDisps[colIndex];
@@ -456,10 +462,13 @@ void View::MarkCells(MarkType _type)
 		return;
 	}
 
-	int index;
-	int numCells = (dataSpace->GetDataSpaceType() == DATASPACE_TYPE_REGION) ? ((Region*)dataSpace)->GetCellsPerCol() : dataSpace->GetNumValues();
+	DataSpaceSnapshot *snapshot = GetSnapshot();
+	if (snapshot == NULL) {
+		return;
+	}
 
-	Region *region = (dataSpace->GetDataSpaceType() == DATASPACE_TYPE_REGION) ? ((Region*)dataSpace) : NULL;
+	int index;
+	int numCells = snapshot->GetNumItems();
 
 	for (int y = 0; y < sceneHeight; y++)
 	{
@@ -467,9 +476,9 @@ void View::MarkCells(MarkType _type)
 		{
 			for (int i = 0; i < numCells; i++)
 			{
-				if (((_type == MARK_ACTIVE) && dataSpace->GetIsActive(x, y, i)) ||
-					  ((_type == MARK_PREDICTED) && (region != NULL) && region->IsCellPredicted(x, y, i)) ||
-						((_type == MARK_LEARNING) && (region != NULL) && region->IsCellLearning(x, y, i)))
+				if (((_type == MARK_ACTIVE) && snapshot->GetIsActive(x, y, i)) ||
+					  ((_type == MARK_PREDICTED) && snapshot->GetIsPredicted(x, y, i)) ||
+						((_type == MARK_LEARNING) && snapshot->GetIsLearning(x, y, i)))
 				{
 					index = (y * sceneWidth * numCells) + (x * numCells) + i;
 					marked_cells[index] = 1;
@@ -578,17 +587,17 @@ void View::UpdateForNetwork(NetworkManager *_networkManager)
 
 	// Add the ID of each InputSpace to the showComboBox.
 	for (std::vector<InputSpace*>::const_iterator input_iter = _networkManager->inputSpaces.begin(), end = _networkManager->inputSpaces.end(); input_iter != end; ++input_iter) {
-		showComboBox->addItem((*input_iter)->GetID());
+		showComboBox->addItem(QString::fromStdString((*input_iter)->GetID()));
 	}
 
 	// Add the ID of each Region to the showComboBox.
 	for (std::vector<Region*>::const_iterator region_iter = _networkManager->regions.begin(), end = _networkManager->regions.end(); region_iter != end; ++region_iter) {
-		showComboBox->addItem((*region_iter)->GetID());
+		showComboBox->addItem(QString::fromStdString((*region_iter)->GetID()));
 	}
 
 	// Add the ID of each Classifier to the showComboBox.
 	for (std::vector<Classifier*>::const_iterator classifier_iter = _networkManager->classifiers.begin(), end = _networkManager->classifiers.end(); classifier_iter != end; ++classifier_iter) {
-		showComboBox->addItem((*classifier_iter)->GetID());
+		showComboBox->addItem(QString::fromStdString((*classifier_iter)->GetID()));
 	}
 
 	// Start with no DataSpace selected, so the selection of the any will trigger a signal.
@@ -619,23 +628,20 @@ void View::GenerateDataImage()
 	Cell *curCell;
 	ProximalSynapse *pSyn;
 
-	if (viewBoost && (dataSpace->GetDataSpaceType() == DATASPACE_TYPE_REGION))
-	{
-		curRegion = (Region*)dataSpace;
+	DataSpaceSnapshot *snapshot = GetSnapshot();
 
+	if (viewBoost && (dataSpace->GetDataSpaceType() == DATASPACE_TYPE_REGION) && (snapshot != NULL))
+	{
 		// For each column...
-		for (colY = 0; colY < curRegion->GetSizeY(); colY++)
+		for (colY = 0; colY < snapshot->GetSizeY(); colY++)
 		{
-			for (colX = 0; colX < curRegion->GetSizeX(); colX++)
+			for (colX = 0; colX < snapshot->GetSizeX(); colX++)
 			{
-				// Get a pointer to the current column.
-				curCol = curRegion->GetColumn(colX, colY);
-				
-				// Record the curColumn's Boost value in its corresponding ColumnDisp's imageVal.
-				columnDisps[colX + (colY * sceneWidth)]->imageVal = curCol->GetBoost() - 1.0f;
+				// Record the column's Boost value, from the displayed snapshot, in its corresponding ColumnDisp's imageVal.
+				columnDisps[colX + (colY * sceneWidth)]->imageVal = snapshot->GetBoost(colX, colY) - 1.0f;
 
-				// Keep track of the maximum Boost value in the curRegion, for normaliation.
-				maxImageVal = Max(maxImageVal, curCol->GetBoost() - 1.0f);
+				// Keep track of the maximum Boost value in the region, for normaliation.
+				maxImageVal = Max(maxImageVal, snapshot->GetBoost(colX, colY) - 1.0f);
 				
 				/*
 				// Record the curColumn's overlap duty cycle value in its corresponding ColumnDisp's imageVal.
@@ -665,7 +671,9 @@ void View::GenerateDataImage()
 		}
 	}
 
-	if (viewReconstruction || viewPrediction)
+	// Reconstruction and prediction are projected through the network's proximal synapses, which may
+	// not be read while it is running. Keep displaying the image generated when last paused.
+	if ((viewReconstruction || viewPrediction) && !win->IsRunning())
 	{
 		int numCells = (dataSpace->GetDataSpaceType() == DATASPACE_TYPE_REGION) ? ((Region*)dataSpace)->GetCellsPerCol() : dataSpace->GetNumValues();
 
@@ -903,7 +911,7 @@ void View::ShowDataSpace(const QString &_id)
 	}
 
 	// Get pointer to DataSpace with given ID.
-	dataSpace = networkManager->GetDataSpace(_id);
+	dataSpace = networkManager->GetDataSpace(_id.toStdString());
 
 	// Clear the scene.
 	scene->clear();
@@ -973,3 +981,11 @@ void View::ShowDataSpace(const QString &_id)
 	marked_cells.clear();
 }
 
+DataSpaceSnapshot *View::GetSnapshot()
+{
+	if ((dataSpace == NULL) || (win->GetSnapshot() == NULL)) {
+		return NULL;
+	}
+
+	return win->GetSnapshot()->GetDataSpaceSnapshot(dataSpace);
+}
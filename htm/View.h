@@ -12,6 +12,7 @@ class QMenu;
 class View;
 class ColumnDisp;
 class htm;
+class DataSpaceSnapshot;
 
 enum MouseMode {
 	MOUSE_MODE_SELECT = 0,
@@ -95,6 +96,9 @@ public:
 	void UpdateForExecution();
 
 	void GenerateDataImage();
+
+	/// Returns the displayed snapshot of this View's DataSpace, or NULL if there is none.
+	DataSpaceSnapshot *GetSnapshot();
 	
 	GraphicsView *graphicsView;
 	QLabel *label_show;
@@ -0,0 +1,85 @@
+#include "WorkerPool.h"
+#include <crtdbg.h>
+
+WorkerPool::WorkerPool(int _numWorkers)
+	: numWorkers(_numWorkers), function(NULL), data(NULL), runCount(0), numThreadsRunning(0), exiting(false)
+{
+	_ASSERT(_numWorkers >= 1);
+
+	// The calling thread is worker 0, so one fewer thread is needed than there are workers.
+	for (int workerIndex = 1; workerIndex < numWorkers; workerIndex++) {
+		threads.push_back(std::thread(&WorkerPool::WorkerLoop, this, workerIndex));
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	// Have each thread exit, and wait for them.
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		exiting = true;
+	}
+	startCondition.notify_all();
+
+	for (std::vector<std::thread>::iterator thread_iter = threads.begin(); thread_iter != threads.end(); ++thread_iter) {
+		thread_iter->join();
+	}
+}
+
+/// Have every worker call the given function with the given data, and wait for them all to return.
+void WorkerPool::Run(WorkerFunction _function, void *_data)
+{
+	// Start the other workers.
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		function = _function;
+		data = _data;
+		numThreadsRunning = (int)threads.size();
+		runCount++;
+	}
+	startCondition.notify_all();
+
+	// Do this thread's share of the work.
+	_function(_data, 0, numWorkers);
+
+	// Wait for the other workers to finish theirs.
+	std::unique_lock<std::mutex> lock(mutex);
+	while (numThreadsRunning > 0) {
+		finishCondition.wait(lock);
+	}
+}
+
+void WorkerPool::WorkerLoop(int _workerIndex)
+{
+	int prevRunCount = 0;
+	WorkerFunction curFunction;
+	void *curData;
+
+	for (;;)
+	{
+		// Wait for new work, or for the pool to be destroyed.
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			while ((runCount == prevRunCount) && !exiting) {
+				startCondition.wait(lock);
+			}
+
+			if (exiting) {
+				return;
+			}
+
+			prevRunCount = runCount;
+			curFunction = function;
+			curData = data;
+		}
+
+		curFunction(curData, _workerIndex, numWorkers);
+
+		// Let Run() know when the last of the workers has finished.
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			numThreadsRunning--;
+		}
+		finishCondition.notify_one();
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/// Function run by each worker of a WorkerPool, given the data passed to WorkerPool::Run(), the
+/// index of the worker, and the number of workers.
+typedef void (*WorkerFunction)(void *_data, int _workerIndex, int _numWorkers);
+
+/// A fixed set of threads that together run a function, each worker calling it once with its own
+/// index so that it may take its own share of the work. The calling thread takes part as worker 0,
+/// and Run() returns only once every worker has finished, so that successive calls to Run() are
+/// separated by a barrier.
+class WorkerPool
+{
+public:
+	WorkerPool(int _numWorkers);
+	~WorkerPool();
+
+	int GetNumWorkers() {return numWorkers;}
+
+	/// Determine the range of items, from _begin up to (but not including) _end, that make up the given
+	/// worker's share of _count items. The shares are contiguous, in order of worker index, and as even as possible.
+	static void DetermineShare(int _count, int _workerIndex, int _numWorkers, int &_begin, int &_end)
+	{
+		_begin = (int)(((long long)_count * _workerIndex) / _numWorkers);
+		_end = (int)(((long long)_count * (_workerIndex + 1)) / _numWorkers);
+	}
+
+	/// Have every worker call the given function with the given data, and wait for them all to return.
+	void Run(WorkerFunction _function, void *_data);
+
+private:
+
+	void WorkerLoop(int _workerIndex);
+
+	int numWorkers;
+	std::vector<std::thread> threads;
+
+	std::mutex mutex;
+	std::condition_variable startCondition, finishCondition;
+
+	// The function being run, and its data.
+	WorkerFunction function;
+	void *data;
+
+	// Incremented by each call to Run(), so that each worker knows when there is new work to start.
+	int runCount;
+
+	// The number of threads (other than the caller) still running the current function.
+	int numThreadsRunning;
+
+	bool exiting;
+};
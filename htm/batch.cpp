@@ -0,0 +1,178 @@
+#include <QtGui/QGuiApplication>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QXmlStreamReader>
+#include <QtCore/QElapsedTimer>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MemManager.h"
+#include "NetworkManager.h"
+
+MemManager mem_manager;
+
+// Information passed to ReportProgress() by NetworkManager::StepN().
+class BatchProgress
+{
+public:
+	QElapsedTimer timer;
+	qint64 prevElapsed;
+	int prevTime;
+};
+
+/// Called by NetworkManager::StepN() after each reporting interval. Prints the current time step
+/// along with the rate of execution over the interval just completed.
+bool ReportProgress(NetworkManager *_networkManager, void *_userData)
+{
+	BatchProgress *progress = (BatchProgress*)_userData;
+	qint64 elapsed = progress->timer.elapsed();
+	int numSteps = _networkManager->GetTime() - progress->prevTime;
+	double seconds = (double)(elapsed - progress->prevElapsed) / 1000.0;
+
+	printf("Time %d: %.1f steps/sec\n", _networkManager->GetTime(), (seconds > 0.0) ? ((double)numSteps / seconds) : 0.0);
+	fflush(stdout);
+
+	progress->prevElapsed = elapsed;
+	progress->prevTime = _networkManager->GetTime();
+
+	return true;
+}
+
+void PrintUsage()
+{
+	printf("Usage: htm_batch <network.xml> [-steps N] [-load data.clad] [-save data.clad] [-report N] [-freeze]\n");
+	printf("  -steps N     Number of time steps to run (default 1000).\n");
+	printf("  -load FILE   Load segment and synapse data into the network before running.\n");
+	printf("  -save FILE   Save the network's segment and synapse data after running.\n");
+	printf("  -report N    Print the rate of execution every N steps (default 0, only at the end).\n");
+	printf("  -freeze      Freeze the network for inference only (no learning) before running.\n");
+}
+
+int main(int argc, char *argv[])
+{
+	QString networkFilename, loadFilename, saveFilename, error_msg;
+	int numSteps = 1000, reportInterval = 0;
+	bool result, freeze = false;
+
+	// Parse the command line.
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "-steps") == 0) && (i + 1 < argc)) {
+			numSteps = atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "-load") == 0) && (i + 1 < argc)) {
+			loadFilename = QString::fromLocal8Bit(argv[++i]);
+		} else if ((strcmp(argv[i], "-save") == 0) && (i + 1 < argc)) {
+			saveFilename = QString::fromLocal8Bit(argv[++i]);
+		} else if ((strcmp(argv[i], "-report") == 0) && (i + 1 < argc)) {
+			reportInterval = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "-freeze") == 0) {
+			freeze = true;
+		} else if ((argv[i][0] != '-') && networkFilename.isEmpty()) {
+			networkFilename = QString::fromLocal8Bit(argv[i]);
+		} else {
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (networkFilename.isEmpty() || (numSteps < 0))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	// Text patterns are rendered using QPainter, which requires a QGuiApplication to exist. No event loop is ever run.
+	QGuiApplication app(argc, argv);
+
+	// Create the NetworkManager
+	NetworkManager *networkManager = new NetworkManager();
+
+	// Open the network file.
+	QFile networkFile(networkFilename);
+	if (!networkFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		fprintf(stderr, "Couldn't open %s\n", networkFilename.toLocal8Bit().constData());
+		delete networkManager;
+		return 1;
+	}
+
+	// Parse the XML file
+	QXmlStreamReader xml(&networkFile);
+	QString shortFilename = QFileInfo(networkFile).fileName();
+	result = networkManager->LoadNetwork(shortFilename, xml, error_msg);
+	networkFile.close();
+
+	if (result == false)
+	{
+		fprintf(stderr, "Error loading network: %s\n", error_msg.toLocal8Bit().constData());
+		delete networkManager;
+		return 1;
+	}
+
+	// Load the network's data, if a data file was given.
+	if (!loadFilename.isEmpty())
+	{
+		QFile dataFile(loadFilename);
+		if (!dataFile.open(QIODevice::ReadOnly))
+		{
+			fprintf(stderr, "Couldn't open %s\n", loadFilename.toLocal8Bit().constData());
+			delete networkManager;
+			return 1;
+		}
+
+		QString shortFilename = QFileInfo(dataFile).fileName();
+		result = networkManager->LoadData(shortFilename, &dataFile, error_msg);
+		dataFile.close();
+
+		if (result == false)
+		{
+			fprintf(stderr, "Error loading data: %s\n", error_msg.toLocal8Bit().constData());
+			delete networkManager;
+			return 1;
+		}
+	}
+
+	// Freeze the network for inference, if requested.
+	if (freeze) {
+		networkManager->Freeze();
+	}
+
+	// Run the network at full speed.
+	BatchProgress progress;
+	progress.prevElapsed = 0;
+	progress.prevTime = networkManager->GetTime();
+	progress.timer.start();
+
+	int stepsRun = networkManager->StepN(numSteps, (reportInterval > 0) ? ReportProgress : NULL, &progress, reportInterval);
+
+	double seconds = (double)(progress.timer.elapsed()) / 1000.0;
+
+	printf("Ran %d steps in %.3f sec (%.1f steps/sec).\n", stepsRun, seconds, (seconds > 0.0) ? ((double)stepsRun / seconds) : 0.0);
+
+	// Save the network's data, if a data file was given.
+	if (!saveFilename.isEmpty())
+	{
+		QFile dataFile(saveFilename);
+		if (!dataFile.open(QIODevice::WriteOnly))
+		{
+			fprintf(stderr, "Couldn't open %s\n", saveFilename.toLocal8Bit().constData());
+			delete networkManager;
+			return 1;
+		}
+
+		QString shortFilename = QFileInfo(dataFile).fileName();
+		result = networkManager->SaveData(shortFilename, &dataFile, error_msg);
+		dataFile.close();
+
+		if (result == false)
+		{
+			fprintf(stderr, "Error saving data: %s\n", error_msg.toLocal8Bit().constData());
+			delete networkManager;
+			return 1;
+		}
+	}
+
+	delete networkManager;
+
+	return 0;
+}
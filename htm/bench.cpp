@@ -0,0 +1,366 @@
+#include <QtGui/QGuiApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+#include <QtCore/QXmlStreamReader>
+#include <QtCore/QElapsedTimer>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MemManager.h"
+#include "NetworkManager.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+MemManager mem_manager;
+
+// Parameters of a network generated by GenerateNetwork().
+class GeneratorParams
+{
+public:
+	GeneratorParams() : size(128), inputSize(-1), inputRadius(8), cellsPerColumn(4), hypercolumnDiameter(1), inhibitionRadius(0), numThreads(1) {}
+
+	int size, inputSize, inputRadius, cellsPerColumn, hypercolumnDiameter;
+
+	// An inhibition radius of 0 means automatic inhibition.
+	int inhibitionRadius;
+
+	// The number of threads that perform the Region's spatial pooling.
+	int numThreads;
+};
+
+void PrintUsage()
+{
+	printf("Usage: htm_bench [network.xml ...] [-steps N] [-warmup N] [-freeze]\n");
+	printf("       htm_bench -generate out.xml [-size N] [-cells N] [-hypercolumn N] [-inhibition N] [-input N] [-inputradius N] [-threads N]\n");
+	printf("  -steps N        Number of timed steps to run for each network (default 1000).\n");
+	printf("  -warmup N       Number of untimed steps to run before timing begins (default 0).\n");
+	printf("  -freeze         Freeze each network for inference only after the warmup steps, and time that.\n");
+	printf("  If no network files are given, every data/*.xml (or ../data/*.xml) file is benchmarked.\n");
+	printf("  -generate FILE  Write a synthetic network of the given dimensions to FILE, rather than benchmarking.\n");
+	printf("  -size N         Width and height of the generated Region, in columns (default 128).\n");
+	printf("  -cells N        CellsPerColumn of the generated Region (default 4).\n");
+	printf("  -hypercolumn N  HypercolumnDiameter of the generated Region (default 1). Must divide the size.\n");
+	printf("  -inhibition N   Fixed inhibition radius, in hypercolumns (default 0, automatic).\n");
+	printf("  -input N        Width and height of the generated InputSpace (default size / 4).\n");
+	printf("  -inputradius N  Input radius of the generated Region (default 8).\n");
+	printf("  -threads N      Number of threads performing the generated Region's spatial pooling (default 1).\n");
+}
+
+/// Returns the peak amount of memory used by this process, in bytes, or 0 if unknown.
+size_t GetPeakMemoryUse()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return counters.PeakWorkingSetSize;
+	}
+#endif
+	return 0;
+}
+
+/// Write a synthetic network to the given file, with a single BouncingBar InputSpace feeding a
+/// single Region, in the same format as the example networks in the data directory.
+bool GenerateNetwork(const char *_filename, GeneratorParams &_params)
+{
+	int inputSize = (_params.inputSize > 0) ? _params.inputSize : Max(16, _params.size / 4);
+
+	if (_params.numThreads < 1)
+	{
+		fprintf(stderr, "The number of threads must be at least 1.\n");
+		return false;
+	}
+
+	if ((_params.hypercolumnDiameter < 1) || ((_params.size % _params.hypercolumnDiameter) != 0))
+	{
+		fprintf(stderr, "The Region size %d must be divisible by the hypercolumn diameter %d.\n", _params.size, _params.hypercolumnDiameter);
+		return false;
+	}
+
+	FILE *file = fopen(_filename, "w");
+	if (file == NULL)
+	{
+		fprintf(stderr, "Couldn't open %s\n", _filename);
+		return false;
+	}
+
+	fprintf(file, "<?xml version=\"1.0\"?>\n");
+	fprintf(file, "<!--\nSynthetic benchmark network generated by htm_bench: %dx%d columns, %d cells per column, hypercolumn diameter %d, inhibition radius %d.\n-->\n",
+		_params.size, _params.size, _params.cellsPerColumn, _params.hypercolumnDiameter, _params.inhibitionRadius);
+	fprintf(file, "<NetConfig xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" xmlns:xsd=\"http://www.w3.org/2001/XMLSchema\">\n");
+	fprintf(file, "\t<ProximalSynapseParams>\n");
+	fprintf(file, "\t\t<InitialPermanence>0.3</InitialPermanence>\n");
+	fprintf(file, "\t\t<ConnectedPermanence>0.2</ConnectedPermanence>\n");
+	fprintf(file, "\t\t<PermanenceIncrease>0.015</PermanenceIncrease>\n");
+	fprintf(file, "\t\t<PermanenceDecrease>0.005</PermanenceDecrease>\n");
+	fprintf(file, "\t</ProximalSynapseParams>\n");
+	fprintf(file, "\t<DistalSynapseParams>\n");
+	fprintf(file, "\t\t<InitialPermanence>0.3</InitialPermanence>\n");
+	fprintf(file, "\t\t<ConnectedPermanence>0.2</ConnectedPermanence>\n");
+	fprintf(file, "\t\t<PermanenceIncrease>0.015</PermanenceIncrease>\n");
+	fprintf(file, "\t\t<PermanenceDecrease>0.005</PermanenceDecrease>\n");
+	fprintf(file, "\t</DistalSynapseParams>\n");
+	fprintf(file, "\t<InputSpace id=\"Input1\">\n");
+	fprintf(file, "\t\t<SizeX>%d</SizeX>\n", inputSize);
+	fprintf(file, "\t\t<SizeY>%d</SizeY>\n", inputSize);
+	fprintf(file, "\t\t<NumValues>1</NumValues>\n");
+	fprintf(file, "\t\t<Pattern type=\"BouncingBar\" trial_duration=\"1\"></Pattern>\n");
+	fprintf(file, "\t</InputSpace>\n");
+	fprintf(file, "\t<Region id=\"Region1\">\n");
+	fprintf(file, "\t\t<SizeX>%d</SizeX>\n", _params.size);
+	fprintf(file, "\t\t<SizeY>%d</SizeY>\n", _params.size);
+	fprintf(file, "\t\t<HypercolumnDiameter>%d</HypercolumnDiameter>\n", _params.hypercolumnDiameter);
+	fprintf(file, "\t\t<HardcodedSpatial>false</HardcodedSpatial>\n");
+	fprintf(file, "\t\t<PercentageInputPerCol>20</PercentageInputPerCol>\n");
+	fprintf(file, "\t\t<PercentageMinOverlap>10</PercentageMinOverlap>\n");
+	fprintf(file, "\t\t<PercentageLocalActivity>6</PercentageLocalActivity>\n");
+	if (_params.inhibitionRadius > 0) {
+		fprintf(file, "\t\t<Inhibition type=\"radius\" radius=\"%d\"></Inhibition>\n", _params.inhibitionRadius);
+	} else {
+		fprintf(file, "\t\t<Inhibition type=\"automatic\"></Inhibition>\n");
+	}
+	fprintf(file, "\t\t<Boost rate=\"0.01\" max=\"3\"></Boost>\n");
+	fprintf(file, "\t\t<SpatialLearningPeriod start=\"-1\" end=\"-1\"></SpatialLearningPeriod>\n");
+	fprintf(file, "\t\t<TemporalLearningPeriod start=\"-1\" end=\"-1\"></TemporalLearningPeriod>\n");
+	fprintf(file, "\t\t<BoostingPeriod start=\"-1\" end=\"-1\"></BoostingPeriod>\n");
+	fprintf(file, "\t\t<MinOverlapToReuseSegment min=\"3\" max=\"5\"></MinOverlapToReuseSegment>\n");
+	fprintf(file, "\t\t<PredictionRadius>10</PredictionRadius>\n");
+	fprintf(file, "\t\t<CellsPerColumn>%d</CellsPerColumn>\n", _params.cellsPerColumn);
+	fprintf(file, "\t\t<SegmentActivateThreshold>5</SegmentActivateThreshold>\n");
+	fprintf(file, "\t\t<NewNumberSynapses>10</NewNumberSynapses>\n");
+	fprintf(file, "\t\t<Threads>%d</Threads>\n", _params.numThreads);
+	fprintf(file, "\t\t<OutputColumnActivity>false</OutputColumnActivity>\n");
+	fprintf(file, "\t\t<OutputCellActivity>true</OutputCellActivity>\n");
+	fprintf(file, "\t\t<Inputs>\n");
+	fprintf(file, "\t\t\t<Input id=\"Input1\" radius=\"%d\"></Input>\n", _params.inputRadius);
+	fprintf(file, "\t\t</Inputs>\n");
+	fprintf(file, "\t</Region>\n");
+	fprintf(file, "</NetConfig>\n");
+
+	fclose(file);
+
+	printf("Wrote %s (%dx%d columns, %d cells per column, %dx%d input).\n", _filename, _params.size, _params.size, _params.cellsPerColumn, inputSize, inputSize);
+
+	return true;
+}
+
+/// Returns the number of distal synapses on the segments of all of the network's cells.
+int CountDistalSynapses(NetworkManager *_networkManager)
+{
+	FastListIter segments_iter;
+	int count = 0;
+
+	for (std::vector<Region*>::iterator region_iter = _networkManager->regions.begin(); region_iter != _networkManager->regions.end(); ++region_iter)
+	{
+		Region *region = (*region_iter);
+
+		for (int colIndex = 0; colIndex < (region->GetSizeX() * region->GetSizeY()); colIndex++)
+		{
+			for (int cellIndex = 0; cellIndex < region->GetCellsPerCol(); cellIndex++)
+			{
+				segments_iter.SetList(region->Columns[colIndex]->GetCellByIndex(cellIndex)->Segments);
+				for (Segment *seg = (Segment*)(segments_iter.Reset()); seg != NULL; seg = (Segment*)(segments_iter.Advance())) {
+					count += seg->GetNumDistalSynapses();
+				}
+			}
+		}
+	}
+
+	return count;
+}
+
+/// Load the given network, run it for the given number of steps, and print the time spent in
+/// each phase of each Region's time step, the overall rate of execution and the memory in use.
+bool BenchmarkNetwork(NetworkManager *_networkManager, QString &_networkFilename, int _numWarmupSteps, int _numSteps, bool _freeze)
+{
+	QString error_msg;
+
+	QFile networkFile(_networkFilename);
+	if (!networkFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		fprintf(stderr, "Couldn't open %s\n", _networkFilename.toLocal8Bit().constData());
+		return false;
+	}
+
+	// Loading the network resets the random seed, so each run of the same network is identical.
+	QXmlStreamReader xml(&networkFile);
+	QString shortFilename = QFileInfo(networkFile).fileName();
+	bool result = _networkManager->LoadNetwork(shortFilename, xml, error_msg);
+	networkFile.close();
+
+	if (result == false)
+	{
+		fprintf(stderr, "Error loading %s: %s\n", shortFilename.toLocal8Bit().constData(), error_msg.toLocal8Bit().constData());
+		return false;
+	}
+
+	printf("\n%s\n", shortFilename.toLocal8Bit().constData());
+
+	// Run any warmup steps, then start timing from a clean slate.
+	_networkManager->StepN(_numWarmupSteps);
+	_networkManager->ResetProfilers();
+
+	if (_freeze) {
+		_networkManager->Freeze();
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	int stepsRun = _networkManager->StepN(_numSteps);
+	double seconds = (double)(timer.elapsed()) / 1000.0;
+
+	printf("  %d steps in %.3f sec (%.1f steps/sec)\n", stepsRun, seconds, (seconds > 0.0) ? ((double)stepsRun / seconds) : 0.0);
+
+	// Report the time spent in each phase, for each Region.
+	for (std::vector<Region*>::iterator region_iter = _networkManager->regions.begin(); region_iter != _networkManager->regions.end(); ++region_iter)
+	{
+		Region *region = (*region_iter);
+		StepProfiler &profiler = region->GetProfiler();
+		double regionSeconds = profiler.GetTotalTime();
+
+		printf("  Region %s: %dx%d columns, %d cells per column, hypercolumn diameter %d, inhibition radius %g, %d thread(s)%s\n", region->GetID().c_str(), region->GetSizeX(), region->GetSizeY(), region->GetCellsPerCol(), region->GetHypercolumnDiameter(), region->InhibitionRadius, region->GetNumThreads(), region->IsFrozen() ? ", frozen" : "");
+		printf("    %-20s %10s %7s %10s %10s %10s\n", "Phase", "ms/step", "%", "p50 ms", "p99 ms", "max ms");
+
+		for (int phase = 0; phase < NUM_STEP_PHASES; phase++)
+		{
+			LatencyHistogram &histogram = profiler.GetPhaseHistogram((StepPhaseEnum)phase);
+			double phaseSeconds = profiler.GetPhaseTime((StepPhaseEnum)phase);
+			printf("    %-20s %10.3f %6.1f%% %10.3f %10.3f %10.3f\n", StepProfiler::GetPhaseName((StepPhaseEnum)phase),
+				histogram.GetMean() * 1000.0, (regionSeconds > 0.0) ? (phaseSeconds * 100.0 / regionSeconds) : 0.0,
+				histogram.GetPercentile(50) * 1000.0, histogram.GetPercentile(99) * 1000.0, histogram.GetMax() * 1000.0);
+		}
+
+		LatencyHistogram &stepHistogram = profiler.GetStepHistogram();
+		printf("    %-20s %10.3f %6.1f%% %10.3f %10.3f %10.3f\n", "Step", stepHistogram.GetMean() * 1000.0, 100.0,
+			stepHistogram.GetPercentile(50) * 1000.0, stepHistogram.GetPercentile(99) * 1000.0, stepHistogram.GetMax() * 1000.0);
+
+		// Report the most recent record of each Statistic that has made one.
+		for (std::vector<Statistic*>::iterator statistic_iter = region->Statistics.begin(); statistic_iter != region->Statistics.end(); ++statistic_iter)
+		{
+			Statistic *statistic = (*statistic_iter);
+
+			if (statistic->GetHistory().empty()) {
+				continue;
+			}
+
+			const StatisticRecord &record = statistic->GetHistory().back();
+			printf("    %s at time %d:", statistic->GetID().c_str(), record.time);
+			for (int valueIndex = 0; valueIndex < statistic->GetNumValues(); valueIndex++) {
+				printf(" %s %g%s", statistic->GetValueName(valueIndex), record.values[valueIndex], (valueIndex < statistic->GetNumValues() - 1) ? "," : "");
+			}
+			printf("\n");
+		}
+	}
+
+	// Report memory use.
+	printf("  Objects: %d proximal synapses, %d distal synapses, %d segments, %d segment updates\n",
+		mem_manager.GetObjectCount(MOT_PROXIMAL_SYNAPSE) - mem_manager.GetFreeObjectCount(MOT_PROXIMAL_SYNAPSE),
+		CountDistalSynapses(_networkManager),
+		mem_manager.GetObjectCount(MOT_SEGMENT) - mem_manager.GetFreeObjectCount(MOT_SEGMENT),
+		mem_manager.GetObjectCount(MOT_SEGMENT_UPDATE_INFO) - mem_manager.GetFreeObjectCount(MOT_SEGMENT_UPDATE_INFO));
+	printf("  Pooled memory: %.1f MB", (double)mem_manager.GetTotalMemUse() / (1024.0 * 1024.0));
+	if (GetPeakMemoryUse() > 0) {
+		printf(", peak process memory: %.1f MB", (double)GetPeakMemoryUse() / (1024.0 * 1024.0));
+	}
+	printf("\n");
+	fflush(stdout);
+
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	QStringList networkFilenames;
+	GeneratorParams generatorParams;
+	const char *generateFilename = NULL;
+	int numSteps = 1000, numWarmupSteps = 0;
+	bool result = true, freeze = false;
+
+	// Parse the command line.
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "-steps") == 0) && (i + 1 < argc)) {
+			numSteps = atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "-warmup") == 0) && (i + 1 < argc)) {
+			numWarmupSteps = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "-freeze") == 0) {
+			freeze = true;
+		} else if ((strcmp(argv[i], "-generate") == 0) && (i + 1 < argc)) {
+			generateFilename = argv[++i];
+		} else if ((strcmp(argv[i], "-size") == 0) && (i + 1 < argc)) {
+			generatorParams.size = atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "-cells") == 0) && (i + 1 < argc)) {
+			generatorParams.cellsPerColumn = atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "-hypercolumn") == 0) && (i + 1 < argc)) {
+			generatorParams.hypercolumnDiameter = atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "-inhibition") == 0) && (i + 1 < argc)) {
+			generatorParams.inhibitionRadius = atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "-input") == 0) && (i + 1 < argc)) {
+			generatorParams.inputSize = atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "-inputradius") == 0) && (i + 1 < argc)) {
+			generatorParams.inputRadius = atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "-threads") == 0) && (i + 1 < argc)) {
+			generatorParams.numThreads = atoi(argv[++i]);
+		} else if (argv[i][0] != '-') {
+			networkFilenames.append(QString::fromLocal8Bit(argv[i]));
+		} else {
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if ((numSteps < 0) || (numWarmupSteps < 0))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	// Generate a network file rather than benchmarking, if requested.
+	if (generateFilename != NULL) {
+		return GenerateNetwork(generateFilename, generatorParams) ? 0 : 1;
+	}
+
+	// Text patterns are rendered using QPainter, which requires a QGuiApplication to exist. No event loop is ever run.
+	QGuiApplication app(argc, argv);
+
+	// If no network files were given, benchmark each of the example networks.
+	if (networkFilenames.isEmpty())
+	{
+		QDir dataDir("data");
+		if (!dataDir.exists()) {
+			dataDir.setPath("../data");
+		}
+
+		QStringList entries = dataDir.entryList(QStringList("*.xml"), QDir::Files, QDir::Name);
+		for (int i = 0; i < entries.size(); i++) {
+			networkFilenames.append(dataDir.filePath(entries[i]));
+		}
+
+		if (networkFilenames.isEmpty())
+		{
+			fprintf(stderr, "No network files given, and none found in the data directory.\n");
+			return 1;
+		}
+	}
+
+	// Create the NetworkManager
+	NetworkManager *networkManager = new NetworkManager();
+
+	printf("Benchmarking %d network(s), %d warmup steps and %d timed steps each.\n", networkFilenames.size(), numWarmupSteps, numSteps);
+
+	for (int i = 0; i < networkFilenames.size(); i++)
+	{
+		if (!BenchmarkNetwork(networkManager, networkFilenames[i], numWarmupSteps, numSteps, freeze)) {
+			result = false;
+		}
+	}
+
+	delete networkManager;
+
+	return result ? 0 : 1;
+}
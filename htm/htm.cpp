@@ -2,6 +2,7 @@
 #include "NetworkManager.h"
 #include "Cell.h"
 #include "Segment.h"
+#include "SimulationThread.h"
 #include <ctime>
 #include <QtWidgets/QAction>
 #include <QtWidgets/QFileDialog>
@@ -10,7 +11,6 @@
 #include <QtWidgets/QHBoxLayout>
 #include <QtCore/QXmlStreamReader>
 #include <QtCore/QTextStream>
-#include <QtCore/QTime>
 #include <QtWidgets/QFrame.h>
 #include <QtWidgets/QPushButton.h>
 #include <QtWidgets/QTabWidget.h>
@@ -35,8 +35,12 @@ htm::htm(NetworkManager *_networkManager, QWidget *_parent)
 	updateWhileRunning = false;
 	networkFrameRequiresUpdate = false;
 	selectedFrameRequiresUpdate = false;
+	profileFrameRequiresUpdate = false;
 	stopTimeVal = 0;
 
+	// Create the thread that runs the network's time steps.
+	simulation = new SimulationThread(networkManager);
+
 	// Create the menu bar.
 	createMenus();
 	
@@ -163,10 +167,29 @@ htm::htm(NetworkManager *_networkManager, QWidget *_parent)
 	selectedFrameLayout->addWidget(deselectSegButton);
 	connect(deselectSegButton, SIGNAL(clicked()), this, SLOT(DeselectSegment()));
 
+	// "Profile" Frame
+
+	// Create the profile frame.
+	profileFrame = new QFrame();
+	QVBoxLayout *profileFrameLayout = new QVBoxLayout();
+	profileFrameLayout->setAlignment(Qt::AlignTop);
+	profileFrame->setLayout(profileFrameLayout);
+
+	// Create the profile info label
+	profileInfo = new QLabel();
+	profileInfo->setAlignment(Qt::AlignTop);
+	profileFrameLayout->addWidget(profileInfo);
+
+	// Reset profile
+	resetProfileButton = new QPushButton("Reset Timings");
+	profileFrameLayout->addWidget(resetProfileButton);
+	connect(resetProfileButton, SIGNAL(clicked()), this, SLOT(ResetProfile()));
+
 	// Create the tabbed widget for the frames in the right-hand panel.
 	tabWidget = new QTabWidget();
 	tabWidget->addTab(networkFrame, tr("Network"));
 	tabWidget->addTab(selectedFrame, tr("Selected"));
+	tabWidget->addTab(profileFrame, tr("Profile"));
 	connect(tabWidget, SIGNAL(currentChanged(int)), this, SLOT(CurrentTabChanged(int)));
 	panelLayout->addWidget(tabWidget);
 		
@@ -191,12 +214,15 @@ htm::htm(NetworkManager *_networkManager, QWidget *_parent)
 	QDesktopWidget desktop;
 	resize(desktop.screenGeometry().width() * 0.75, desktop.screenGeometry().height() * 0.75);
 
-	// Initialize the UI for the (empty) network.
+	// Initialize the snapshots and the UI for the (empty) network.
+	simulation->ResetSnapshots();
 	UpdateUIForNetwork();
 }
 
 htm::~htm()
 {
+	// Stop the simulation thread before the network is deleted.
+	delete simulation;
 }
 
 void htm::keyPressEvent(QKeyEvent* e)
@@ -239,38 +265,25 @@ void htm::timerEvent(QTimerEvent *event)
 {
 	if (event->timerId() == timer.timerId()) 
 	{
-		QTime start_time;
-		start_time.start();
-
-			// Get the latest value for the stop time.
+		// Get the latest value for the stop time.
 		if (stopTime->isModified()) 
 		{
 			stopTimeVal = stopTime->text().toInt();
 			stopTime->setModified(false);
+			simulation->SetStopTime(stopTimeVal);
 		}
 
-		// Run as many time steps as will fit within a small limited time period.
-		do
+		// If the simulation thread has stopped on its own, the stop time has been reached.
+		if (!simulation->isRunning())
 		{
-			// Execute one step for the network.
-			networkManager->Step();
-
-			// If the current time is the stop time, pause and exit loop.
-			if (networkManager->GetTime() == stopTimeVal) 
-			{
-				Pause();
-				break;
-			}
-
-			// If the UI is to be updated while running, run only one step at a time.
-			if (updateWhileRunning) {
-				break;
-			}
-		} 
-		while ((start_time.elapsed()) < 500);
+			Pause();
+			return;
+		}
 
-		// Update the UI
-		UpdateUIForNetworkExecution();
+		// If the simulation thread has published a new snapshot, update the UI to display it.
+		if (simulation->AcquireSnapshot()) {
+			UpdateUIForNetworkExecution();
+		}
 	} 
 	else 
 	{
@@ -370,10 +383,16 @@ void htm::loadNetworkFile()
 		// Load the XML stream from the file.
     QXmlStreamReader xml(file);
 
+		// The network must not be running while it is replaced.
+		Pause();
+
 		// Parse the XML file
 		QString error_msg;
 		bool result = networkManager->LoadNetwork(QFileInfo(*file).fileName(), xml, error_msg);
 
+		// Rebuild the snapshots for the new network's DataSpaces.
+		simulation->ResetSnapshots();
+
 		if (result == false) 
 		{
 			QMessageBox::critical(this,	"Error loading network.", error_msg, QMessageBox::Ok);
@@ -410,10 +429,17 @@ void htm::loadDataFile()
 			return;
 		}
     
+		// The network must not be running while its data is replaced.
+		Pause();
+
 		// Parse the data file
 		QString error_msg;
 		bool result = networkManager->LoadData(QFileInfo(*file).fileName(), file, error_msg);
 
+		// Display the network's state as it is after loading.
+		simulation->PublishSnapshot();
+		simulation->AcquireSnapshot();
+
 		if (result == false) 
 		{
 			QMessageBox::critical(this,	"Error loading data.", error_msg, QMessageBox::Ok);
@@ -441,6 +467,9 @@ void htm::saveDataFile()
 			return;
 		}
 
+		// The network must not be running while its data is saved.
+		Pause();
+
 		// Save the data file
 		QString error_msg;
 		bool result = networkManager->SaveData(QFileInfo(*file).fileName(), file, error_msg);
@@ -466,6 +495,11 @@ void htm::MouseMode_Drag()
 void htm::ViewMode_UpdateWhileRunning()
 {
 	updateWhileRunning = viewDuringRunAct->isChecked();
+
+	// Change the rate at which the UI is updated while running.
+	if (running) {
+		timer.start(updateWhileRunning ? 30 : 500, this);
+	}
 }
 
 void htm::Pause()
@@ -474,6 +508,9 @@ void htm::Pause()
 		return;
 	}
 
+	// Stop the simulation thread, waiting for the current step to finish.
+	simulation->StopRunning();
+
 	running = false;
 
 	pauseButton->setDisabled(true);
@@ -483,10 +520,12 @@ void htm::Pause()
 	// Stop timer.
 	timer.stop();
 
-	// If the UI hasn't been updated fully while running, update fully now.
-	if (!updateWhileRunning) {
-		UpdateUIForNetworkExecution();
-	}
+	// Display the state the network was left in, and update the UI fully, including those parts
+	// that are not updated while running. The UI reads proximal synapses' permanences directly.
+	networkManager->StoreProximalPermanences();
+	simulation->PublishSnapshot();
+	simulation->AcquireSnapshot();
+	UpdateUIForNetworkExecution();
 }
 
 void htm::Step()
@@ -497,6 +536,11 @@ void htm::Step()
 
 	// Have the network manager take one step.
 	networkManager->Step();
+	networkManager->StoreProximalPermanences();
+
+	// Display the network's new state.
+	simulation->PublishSnapshot();
+	simulation->AcquireSnapshot();
 
 	// Update UI
 	UpdateUIForNetworkExecution();
@@ -514,8 +558,15 @@ void htm::Run()
 	stepButton->setDisabled(true);
 	runButton->setDisabled(true);
 
-	// Start timer.
-	timer.start(0, this);
+	// Start the simulation thread.
+	stopTimeVal = stopTime->text().toInt();
+	stopTime->setModified(false);
+	simulation->SetStopTime(stopTimeVal);
+	simulation->StartRunning();
+
+	// Start timer, which displays the snapshots published by the simulation thread. When the UI is
+	// to be updated while running, it is updated at a rate suitable for watching.
+	timer.start(updateWhileRunning ? 30 : 500, this);
 }
 
 void htm::SelectSegment(const QModelIndex & current, const QModelIndex & previous)
@@ -546,6 +597,28 @@ void htm::CurrentTabChanged(int _currentTabIndex)
 		UpdateSelectedInfo();
 		selectedFrameRequiresUpdate = false;
 	}
+
+	if (profileFrameRequiresUpdate)
+	{
+		UpdateProfileInfo();
+		profileFrameRequiresUpdate = false;
+	}
+}
+
+void htm::ResetProfile()
+{
+	// The profilers belong to the network, so they may only be reset between steps.
+	bool wasRunning = running;
+	Pause();
+
+	networkManager->ResetProfilers();
+	simulation->PublishSnapshot();
+	simulation->AcquireSnapshot();
+	UpdateProfileInfo();
+
+	if (wasRunning) {
+		Run();
+	}
 }
 
 void htm::UpdateUIForNetwork()
@@ -568,6 +641,7 @@ void htm::UpdateUIForNetwork()
 
 	// Update information frames.
 	UpdateSelectedInfo();
+	UpdateProfileInfo();
 }
 
 void htm::UpdateUIForNetworkExecution()
@@ -575,6 +649,9 @@ void htm::UpdateUIForNetworkExecution()
 	// Update the network UI
 	UpdateNetworkInfo();
 
+	// Update the step timings.
+	UpdateProfileInfo();
+
 	// Do not update the rest of the UI if currently running, and the UI isn't to be updated while running.
 	if (running && !updateWhileRunning) {
 		return;
@@ -605,7 +682,7 @@ void htm::UpdateNetworkInfo()
 		return;
 	}
 
-	networkTime->setText(QString("Time: %1").arg(networkManager->GetTime()));
+	networkTime->setText(QString("Time: %1").arg(GetSnapshot()->GetTime()));
 
 	// If currently running, don't update the rest of the network UI.
 	if (running) {
@@ -624,6 +701,16 @@ void htm::UpdateSelectedInfo()
 		return;
 	}
 
+	// The selected item's details are read directly from the network, which may not be read while
+	// it is running. They are updated once the network is paused.
+	if (running)
+	{
+		selectedInfo->setText("<i>Details are updated when paused.</i>");
+		segmentsTable->setVisible(false);
+		deselectSegButton->setVisible(false);
+		return;
+	}
+
 	Cell *selCell = NULL;
 	QString infoString;
 	QTextStream info(&infoString);
@@ -631,7 +718,7 @@ void htm::UpdateSelectedInfo()
 
 	if (selInput != NULL)
 	{
-		info << "<b><u>InputSpace:</b> " << selInput->GetID() << "</u><br>";
+		info << "<b><u>InputSpace:</b> " << QString::fromStdString(selInput->GetID()) << "</u><br>";
 		info << "Dimensions: " << selInput->GetSizeX() << " x " << selInput->GetSizeY() << "<br>";
 		info << "<br>";
 		info << "<b><u>Column:</b> " << selColX << "," << selColY << "</u><br>";
@@ -647,7 +734,7 @@ void htm::UpdateSelectedInfo()
 	{
 		Column *selCol = selRegion->GetColumn(selColX, selColY);
 
-		info << "<b><u>Region:</b> " << selRegion->GetID() << "</u><br>";
+		info << "<b><u>Region:</b> " << QString::fromStdString(selRegion->GetID()) << "</u><br>";
 		info << "Dimensions: " << selRegion->GetSizeX() << " x " << selRegion->GetSizeY() << "<br>";
 		info << "Time: " << networkManager->GetTime() << "<br>";
 		info << "<br>";
@@ -701,13 +788,13 @@ void htm::UpdateSelectedInfo()
 				item = new QTableWidgetItem(tr("%1").arg(seg->GetNumPredictionSteps()));
 				segmentsTable->setItem(numSegments, 1, item);
 
-				item = new QTableWidgetItem(tr("%1").arg(seg->Synapses.Count()));
+				item = new QTableWidgetItem(tr("%1").arg(seg->GetNumDistalSynapses()));
 				segmentsTable->setItem(numSegments, 2, item);
 
-				item = new QTableWidgetItem(tr("%1 (%2)").arg(seg->GetIsActive() ? "Y" : "N").arg(seg->ActiveSynapses.Count()));
+				item = new QTableWidgetItem(tr("%1 (%2)").arg(seg->GetIsActive() ? "Y" : "N").arg(seg->GetActiveSynapseCount()));
 				segmentsTable->setItem(numSegments, 3, item);
 
-				item = new QTableWidgetItem(tr("%1 (%2)").arg(seg->GetWasActive() ? "Y" : "N").arg(seg->PrevActiveSynapses.Count()));
+				item = new QTableWidgetItem(tr("%1 (%2)").arg(seg->GetWasActive() ? "Y" : "N").arg(seg->GetPrevActiveSynapseCount()));
 				segmentsTable->setItem(numSegments, 4, item);
 
 				item = new QTableWidgetItem(tr("%1").arg(seg->GetCreationTime()));
@@ -741,3 +828,55 @@ void htm::UpdateSelectedInfo()
 
 	selectedInfo->setText(infoString);
 }
+
+void htm::UpdateProfileInfo()
+{
+	// Do not update the profile frame if it is not currently visible.
+	if (tabWidget->currentWidget() != profileFrame)
+	{
+		profileFrameRequiresUpdate = true;
+		return;
+	}
+
+	QString infoString;
+	QTextStream info(&infoString);
+
+	info.setRealNumberNotation(QTextStream::FixedNotation);
+	info.setRealNumberPrecision(3);
+
+	for (std::vector<Region*>::const_iterator region_iter = networkManager->regions.begin(), end = networkManager->regions.end(); region_iter != end; ++region_iter)
+	{
+		// Read the Region's timings from the displayed snapshot, as the Region may be running.
+		DataSpaceSnapshot *regionSnapshot = GetSnapshot()->GetDataSpaceSnapshot(*region_iter);
+		if (regionSnapshot == NULL) {
+			continue;
+		}
+
+		StepProfiler &profiler = regionSnapshot->GetProfiler();
+		LatencyHistogram &stepHistogram = profiler.GetStepHistogram();
+		double totalTime = profiler.GetTotalTime();
+
+		info << "<b><u>Region:</b> " << QString::fromStdString((*region_iter)->GetID()) << "</u><br>";
+		info << "Steps timed: " << profiler.GetNumSteps() << "<br>";
+		info << "Step ms: p50 " << (stepHistogram.GetPercentile(50) * 1000.0) << ", p99 " << (stepHistogram.GetPercentile(99) * 1000.0) << ", max " << (stepHistogram.GetMax() * 1000.0) << "<br>";
+		info << "<table cellspacing=2><tr><th align=left>Phase</th><th align=right>ms/step</th><th align=right>%</th><th align=right>p99</th></tr>";
+
+		for (int phase = 0; phase < NUM_STEP_PHASES; phase++)
+		{
+			LatencyHistogram &histogram = profiler.GetPhaseHistogram((StepPhaseEnum)phase);
+			info << "<tr><td>" << StepProfiler::GetPhaseName((StepPhaseEnum)phase) << "</td>";
+			info << "<td align=right>" << (histogram.GetMean() * 1000.0) << "</td>";
+			info << "<td align=right>" << qSetRealNumberPrecision(1) << ((totalTime > 0.0) ? (profiler.GetPhaseTime((StepPhaseEnum)phase) * 100.0 / totalTime) : 0.0) << qSetRealNumberPrecision(3) << "</td>";
+			info << "<td align=right>" << (histogram.GetPercentile(99) * 1000.0) << "</td></tr>";
+		}
+
+		info << "</table><br>";
+	}
+
+	profileInfo->setText(infoString);
+}
+
+NetworkSnapshot *htm::GetSnapshot()
+{
+	return simulation->GetSnapshot();
+}
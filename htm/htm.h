@@ -10,6 +10,8 @@
 #include "View.h"
 
 class NetworkManager;
+class NetworkSnapshot;
+class SimulationThread;
 class QLineEdit;
 class QPushButton;
 
@@ -26,6 +28,12 @@ public:
 
 	void SetSelected(Region *_region, InputSpace *_input, int _colX, int _colY, int _cellIndex, int _segmentIndex);
 
+	bool IsRunning() {return running;}
+
+	/// Returns the snapshot of the network's state that is currently being displayed. While running,
+	/// the views must read the network's state only from this snapshot.
+	NetworkSnapshot *GetSnapshot();
+
 private slots:
 	void loadNetworkFile();
 	void loadDataFile();
@@ -45,6 +53,8 @@ private slots:
 
 	void CurrentTabChanged(int _currentTabIndex);
 
+	void ResetProfile();
+
 private:
 	void createMenus();
 
@@ -55,8 +65,10 @@ private:
 
 	void UpdateNetworkInfo();
 	void UpdateSelectedInfo();
+	void UpdateProfileInfo();
 
 	NetworkManager *networkManager;
+	SimulationThread *simulation;
 
 	QMenu *fileMenu, *viewMenu, *mouseMenu;
 	QAction *loadNetworkAct, *loadDataAct, *saveDataAct;
@@ -67,12 +79,13 @@ private:
 	View *view1, *view2;
 
 	QTabWidget *tabWidget;
-	QFrame *networkFrame, *selectedFrame, *testFrame;
-	QLabel *networkName, *networkTime, *networkInfo, *selectedInfo;
+	QFrame *networkFrame, *selectedFrame, *profileFrame, *testFrame;
+	QLabel *networkName, *networkTime, *networkInfo, *selectedInfo, *profileInfo;
 	QLineEdit *stopTime;
 	QPushButton *pauseButton, *stepButton, *runButton;
 	QTableWidget *segmentsTable;
 	QPushButton *deselectSegButton;
+	QPushButton *resetProfileButton;
 
 	MouseMode mouseMode;
 
@@ -82,7 +95,7 @@ private:
 
 	bool running;
 	bool updateWhileRunning;
-	bool networkFrameRequiresUpdate, selectedFrameRequiresUpdate;
+	bool networkFrameRequiresUpdate, selectedFrameRequiresUpdate, profileFrameRequiresUpdate;
 	int stopTimeVal;
 	QBasicTimer timer;
 };